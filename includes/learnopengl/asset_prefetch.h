@@ -0,0 +1,279 @@
+#ifndef ASSET_PREFETCH_H
+#define ASSET_PREFETCH_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/view_frustum.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Something loaded in two steps: Decode reads and decodes the files and runs on the prefetcher's loader
+// thread, so it must not touch OpenGL; Upload hands the decoded data to OpenGL and runs on the thread that
+// owns the context, after Decode
+class StreamedAsset
+{
+public:
+    virtual ~StreamedAsset() {}
+    virtual void Decode() = 0;
+    virtual void Upload() = 0;
+};
+
+// Streams an object with Decode and Upload methods, e.g. a Model built with deferred = true
+template <typename T>
+class StreamedAssetOf : public StreamedAsset
+{
+public:
+    T *Asset;
+
+    StreamedAssetOf(T *asset) : Asset(asset) {}
+
+    void Decode() {
+        Asset->Decode();
+    }
+
+    void Upload() {
+        Asset->Upload();
+    }
+};
+
+enum AssetState {
+    ASSET_UNLOADED,
+    ASSET_QUEUED,           // waiting for the loader thread
+    ASSET_DECODING,
+    ASSET_DECODED,          // waiting for Upload
+    ASSET_READY
+};
+
+// Projection * view of a camera at steps + 1 times from now to now + ahead, found by running a copy of
+// the camera forward: its queued transformations (paths, translations, rotations...) say where it will be.
+// Transformations queued later, or moved by hand, aren't known yet
+inline void PredictViews(const Camera &camera, float now, float ahead, unsigned int steps, float aspect, std::vector<glm::mat4> &views)
+{
+    Camera future = camera;
+    future.Clock = NULL;
+    views.resize(steps + 1);
+    for(unsigned int s = 0; s <= steps; s++){
+        future.evaluateAt(now + (steps ? ahead * s / steps : 0.0f));
+        views[s] = future.GetViewProjectionMatrix(aspect, 1.0f);
+    }
+}
+
+// Loads assets shortly before a camera gets to see them. Each asset has a bounding sphere; Update looks
+// LookAhead seconds into the camera's future (see PredictViews) and queues the assets that come into view,
+// the soonest first, for a loader thread to decode. Upload, called once per frame on the OpenGL thread,
+// then uploads a few decoded ones, so no frame pays for loading a whole scene. Draw an asset once Ready,
+// or Require it when it's needed this frame whatever the cost. Loaded assets stay loaded.
+class AssetPrefetcher
+{
+public:
+    float LookAhead;        // seconds
+    unsigned int Steps;     // predicted views over LookAhead
+    float Margin;           // added to every radius, so assets just off screen load too
+
+    AssetPrefetcher(float lookAhead = 2.0f, unsigned int steps = 8, float margin = 1.0f) : LookAhead(lookAhead), Steps(steps), Margin(margin), stop(false) {}
+
+    ~AssetPrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        if(loader.joinable())
+            loader.join();
+    }
+
+    // Returns the asset's id. The prefetcher doesn't own the asset
+    unsigned int Add(StreamedAsset *asset, glm::vec3 center, float radius)
+    {
+        entry e;
+        e.Asset = asset;
+        e.Center = center;
+        e.Radius = radius;
+        e.State = ASSET_UNLOADED;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back(e);
+        return (unsigned int)entries.size() - 1;
+    }
+
+    // Queues the assets the camera will see within LookAhead seconds from now and returns how many.
+    // aspect is the viewport's width / height
+    unsigned int Update(const Camera &camera, float now, float aspect)
+    {
+        PredictViews(camera, now, LookAhead, Steps, aspect, views);
+        frustums.resize(views.size());
+        for(unsigned int s = 0; s < views.size(); s++)
+            frustums[s] = FrustumFromMatrix(views[s]);
+
+        unsigned int queued = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        // step by step, so assets seen sooner are decoded sooner
+        for(unsigned int s = 0; s < frustums.size(); s++)
+            for(unsigned int i = 0; i < entries.size(); i++){
+                entry &e = entries[i];
+                if(e.State == ASSET_UNLOADED && SphereInFrustum(frustums[s], e.Center, e.Radius + Margin)){
+                    e.State = ASSET_QUEUED;
+                    queue.push_back(i);
+                    queued++;
+                }
+            }
+        lock.unlock();
+
+        if(queued)
+            startLoader();
+        return queued;
+    }
+
+    // Queues an asset whatever the cameras do, e.g. one that's always on screen
+    void Request(unsigned int id)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(entries[id].State != ASSET_UNLOADED)
+            return;
+        entries[id].State = ASSET_QUEUED;
+        queue.push_back(id);
+        lock.unlock();
+        startLoader();
+    }
+
+    // Uploads at most max decoded assets, oldest first, and returns how many. Call it on the OpenGL thread
+    unsigned int Upload(unsigned int max = 1)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned int count = 0;
+        while(count < max && !decoded.empty()){
+            unsigned int id = decoded.front();
+            decoded.pop_front();
+            // Add may grow entries while the lock is released
+            StreamedAsset *asset = entries[id].Asset;
+            lock.unlock();
+            asset->Upload();
+            lock.lock();
+            entries[id].State = ASSET_READY;
+            count++;
+        }
+        return count;
+    }
+
+    // Whether the asset can be drawn. Call it on the OpenGL thread
+    bool Ready(unsigned int id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries[id].State == ASSET_READY;
+    }
+
+    // Loads the asset now if it isn't ready: decodes it here unless the loader thread already is, and
+    // uploads it. For assets the prediction missed, at the cost of a hitch
+    void Require(unsigned int id)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // entries is only indexed under the lock, as Add may grow it while the lock is released
+        StreamedAsset *asset = entries[id].Asset;
+        if(entries[id].State == ASSET_UNLOADED || entries[id].State == ASSET_QUEUED){
+            if(entries[id].State == ASSET_QUEUED)
+                remove(queue, id);
+            entries[id].State = ASSET_DECODING;
+            lock.unlock();
+            asset->Decode();
+            lock.lock();
+            entries[id].State = ASSET_DECODED;
+            decoded.push_back(id);
+        }
+        while(entries[id].State == ASSET_DECODING)
+            done.wait(lock);
+        if(entries[id].State == ASSET_DECODED){
+            remove(decoded, id);
+            lock.unlock();
+            asset->Upload();
+            lock.lock();
+            entries[id].State = ASSET_READY;
+        }
+    }
+
+    AssetState State(unsigned int id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries[id].State;
+    }
+
+    // Assets queued or being decoded
+    unsigned int Pending()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        unsigned int count = (unsigned int)queue.size();
+        for(unsigned int i = 0; i < entries.size(); i++)
+            if(entries[i].State == ASSET_DECODING)
+                count++;
+        return count;
+    }
+
+private:
+    struct entry {
+        StreamedAsset *Asset;
+        glm::vec3 Center;
+        float Radius;
+        AssetState State;       // guarded by mutex
+    };
+
+    std::vector<entry> entries;
+    std::deque<unsigned int> queue;         // to decode, soonest first
+    std::deque<unsigned int> decoded;       // to upload
+
+    std::mutex mutex;
+    std::condition_variable wake;           // something was queued, or stop
+    std::condition_variable done;           // something was decoded
+    std::thread loader;
+    bool stop;
+
+    // kept between Updates so predicting doesn't allocate
+    std::vector<glm::mat4> views;
+    std::vector<viewFrustum> frustums;
+
+    AssetPrefetcher(const AssetPrefetcher &);
+    AssetPrefetcher &operator=(const AssetPrefetcher &);
+
+    void startLoader()
+    {
+        if(!loader.joinable())
+            loader = std::thread(&AssetPrefetcher::load, this);
+        wake.notify_one();
+    }
+
+    void load()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(;;){
+            while(!stop && queue.empty())
+                wake.wait(lock);
+            if(stop)
+                return;
+
+            unsigned int id = queue.front();
+            queue.pop_front();
+            entries[id].State = ASSET_DECODING;
+            StreamedAsset *asset = entries[id].Asset;
+            lock.unlock();
+            asset->Decode();
+            lock.lock();
+            entries[id].State = ASSET_DECODED;
+            decoded.push_back(id);
+            done.notify_all();
+        }
+    }
+
+    static void remove(std::deque<unsigned int> &list, unsigned int id)
+    {
+        for(std::deque<unsigned int>::iterator i = list.begin(); i != list.end(); ++i)
+            if(*i == id){
+                list.erase(i);
+                return;
+            }
+    }
+};
+#endif
@@ -0,0 +1,237 @@
+#ifndef BEZIER_CURVE_H
+#define BEZIER_CURVE_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Bezier curves of any degree, rational Bezier curves and NURBS, all evaluated by de Casteljau / de Boor
+// with the degree as a template parameter. The loops are unrolled by template recursion, so a curve of
+// degree N compiles down to N (N + 1) / 2 straight-line lerps (a + t (b - a), one FMA per component) with
+// no loop counters or branches. Every curve is a function object of t in [0, 1], so it can be baked with
+// CameraPath::FromCurve for constant speed and orientation along it.
+
+// One de Casteljau level: p[i] = lerp(p[i], p[i + 1], t) for I <= i < K
+template <unsigned int I, unsigned int K>
+struct casteljauStep {
+    template <typename T>
+    static void Apply(T *p, float t){
+        p[I] += t * (p[I + 1] - p[I]);
+        casteljauStep<I + 1, K>::Apply(p, t);
+    }
+};
+
+template <unsigned int K>
+struct casteljauStep<K, K> {
+    template <typename T>
+    static void Apply(T *, float){}
+};
+
+// Levels K, K - 1, ..., 1, leaving the point in p[0]
+template <unsigned int K>
+struct casteljauLevels {
+    template <typename T>
+    static void Apply(T *p, float t){
+        casteljauStep<0, K>::Apply(p, t);
+        casteljauLevels<K - 1>::Apply(p, t);
+    }
+};
+
+template <>
+struct casteljauLevels<0> {
+    template <typename T>
+    static void Apply(T *, float){}
+};
+
+// Point at t of the degree N Bezier curve with control points p[0..N]. T is glm::vec3, or glm::vec4
+// for homogeneous (rational) points
+template <unsigned int N, typename T>
+inline T DeCasteljau(const T *p, float t)
+{
+    T q[N + 1];
+    for(unsigned int i = 0; i <= N; i++)
+        q[i] = p[i];
+    casteljauLevels<N>::Apply(q, t);
+    return q[0];
+}
+
+template <unsigned int N>
+struct BezierCurve {
+    glm::vec3 P[N + 1];
+
+    glm::vec3 operator()(float t) const {
+        return DeCasteljau<N>(P, t);
+    }
+
+    // Derivative with respect to t: N times the degree N - 1 curve of the control point differences
+    glm::vec3 Derivative(float t) const {
+        glm::vec3 d[N];
+        for(unsigned int i = 0; i < N; i++)
+            d[i] = float(N) * (P[i + 1] - P[i]);
+        return DeCasteljau<N - 1>(d, t);
+    }
+};
+
+// Bezier curve with a weight per control point. Weights bend the curve towards (> 1) or away from (< 1)
+// their point, and make conics, e.g. circular arcs, exact instead of approximated
+template <unsigned int N>
+struct RationalBezierCurve {
+    // Control points premultiplied by their weight, with the weight in w
+    glm::vec4 H[N + 1];
+
+    void Set(unsigned int i, glm::vec3 point, float weight){
+        H[i] = glm::vec4(point * weight, weight);
+    }
+
+    glm::vec3 operator()(float t) const {
+        glm::vec4 h = DeCasteljau<N>(H, t);
+        return glm::vec3(h) / h.w;
+    }
+};
+
+// Exact circular arc around center from one point to another at the same distance from it, turning the
+// short way (less than half a turn). Points on the same line as center have no single arc between them
+inline RationalBezierCurve<2> CircularArc(glm::vec3 center, glm::vec3 from, glm::vec3 to)
+{
+    glm::vec3 a = from - center, b = to - center;
+    float cosTheta = glm::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.0f, 1.0f);
+    float halfAngle = std::acos(cosTheta) / 2;
+    float weight = std::cos(halfAngle);
+
+    // the middle control point is where the tangents at both ends meet
+    glm::vec3 bisector = a + b;
+    float length = glm::length(bisector);
+    glm::vec3 middle = length > 0 && weight > 0 ? center + bisector / length * (glm::length(a) / weight) : (from + to) / 2.0f;
+
+    RationalBezierCurve<2> arc;
+    arc.Set(0, from, 1.0f);
+    arc.Set(1, middle, weight);
+    arc.Set(2, to, 1.0f);
+    return arc;
+}
+
+// One de Boor level R: d[j] = lerp(d[j - 1], d[j], alpha_j) for j = P down to R, Left steps to go
+template <unsigned int Left, unsigned int R, unsigned int P>
+struct deBoorStep {
+    static void Apply(glm::vec4 *d, const float *knots, unsigned int k, float u){
+        const unsigned int j = R + Left - 1;
+        float left = knots[j + k - P];
+        float span = knots[j + 1 + k - R] - left;
+        float alpha = span > 0 ? (u - left) / span : 0.0f;
+        d[j] = d[j - 1] + alpha * (d[j] - d[j - 1]);
+        deBoorStep<Left - 1, R, P>::Apply(d, knots, k, u);
+    }
+};
+
+template <unsigned int R, unsigned int P>
+struct deBoorStep<0, R, P> {
+    static void Apply(glm::vec4 *, const float *, unsigned int, float){}
+};
+
+// Levels 1 to P, Left levels to go, leaving the point in d[P]
+template <unsigned int Left, unsigned int P>
+struct deBoorLevels {
+    static void Apply(glm::vec4 *d, const float *knots, unsigned int k, float u){
+        const unsigned int r = P - Left + 1;
+        deBoorStep<P - r + 1, r, P>::Apply(d, knots, k, u);
+        deBoorLevels<Left - 1, P>::Apply(d, knots, k, u);
+    }
+};
+
+template <unsigned int P>
+struct deBoorLevels<0, P> {
+    static void Apply(glm::vec4 *, const float *, unsigned int, float){}
+};
+
+// Non-uniform rational B-spline of degree Degree, with any number of weighted control points.
+// The knot vector is clamped, so the curve starts and ends on the first and last points; UniformKnots
+// spaces the inner knots evenly, or Knots can be filled by hand (Points + Degree + 1 of them).
+template <unsigned int Degree>
+class NurbsCurve
+{
+public:
+    // Control points premultiplied by their weight, with the weight in w
+    std::vector<glm::vec4> Points;
+    std::vector<float> Knots;
+
+    void Add(glm::vec3 point, float weight = 1.0f){
+        Points.push_back(glm::vec4(point * weight, weight));
+    }
+
+    // Clamped knots, evenly spaced in [0, 1]
+    void UniformKnots()
+    {
+        unsigned int n = (unsigned int)Points.size();
+        Knots.assign(n + Degree + 1, 0.0f);
+        if(n <= Degree)
+            return;
+        unsigned int inner = n - Degree;
+        for(unsigned int i = 0; i < Knots.size(); i++){
+            int k = (int)i - (int)Degree;
+            Knots[i] = std::min(std::max(k, 0), (int)inner) / (float)inner;
+        }
+    }
+
+    // Span k with Knots[k] <= u < Knots[k + 1], checking the cursor first
+    unsigned int FindSpan(float u, unsigned int &cursor) const
+    {
+        unsigned int last = (unsigned int)Points.size() - 1;
+        if(cursor >= Degree && cursor <= last && u >= Knots[cursor] && u < Knots[cursor + 1])
+            return cursor;
+        if(u >= Knots[last + 1])
+            return cursor = last;
+
+        cursor = (unsigned int)(std::upper_bound(Knots.begin() + Degree, Knots.begin() + last + 1, u) - Knots.begin()) - 1;
+        return cursor;
+    }
+
+    // Point at a knot value u, clamped to the curve
+    glm::vec3 Evaluate(float u, unsigned int &cursor) const
+    {
+        if(Points.size() <= Degree || Knots.size() != Points.size() + Degree + 1)
+            return Points.empty() ? glm::vec3(0) : glm::vec3(Points[0]) / Points[0].w;
+
+        u = std::min(std::max(u, Knots[Degree]), Knots[Points.size()]);
+        unsigned int k = FindSpan(u, cursor);
+        glm::vec4 d[Degree + 1];
+        for(unsigned int j = 0; j <= Degree; j++)
+            d[j] = Points[j + k - Degree];
+        deBoorLevels<Degree, Degree>::Apply(d, &Knots[0], k, u);
+        return glm::vec3(d[Degree]) / d[Degree].w;
+    }
+
+    // Point at a fraction of the knot range
+    glm::vec3 operator()(float t) const
+    {
+        if(Knots.empty())
+            return Points.empty() ? glm::vec3(0) : glm::vec3(Points[0]) / Points[0].w;
+
+        unsigned int cursor = Degree;
+        float begin = Knots[std::min((unsigned int)Knots.size() - 1, Degree)];
+        float end = Knots[std::min((unsigned int)Knots.size() - 1, (unsigned int)Points.size())];
+        return Evaluate(begin + t * (end - begin), cursor);
+    }
+};
+
+// Exact full circle around center, in the plane through it spanned by the two (perpendicular) axes,
+// starting at center + radius * axisX: the usual nine point quadratic NURBS made of four quarter arcs
+inline NurbsCurve<2> NurbsCircle(glm::vec3 center, float radius, glm::vec3 axisX = glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3 axisY = glm::vec3(0.0f, 0.0f, -1.0f))
+{
+    glm::vec3 x = glm::normalize(axisX) * radius, y = glm::normalize(axisY) * radius;
+    const float corner = std::sqrt(0.5f);
+    const glm::vec2 points[9] = {
+        glm::vec2(1, 0), glm::vec2(1, 1), glm::vec2(0, 1), glm::vec2(-1, 1), glm::vec2(-1, 0),
+        glm::vec2(-1, -1), glm::vec2(0, -1), glm::vec2(1, -1), glm::vec2(1, 0)
+    };
+
+    NurbsCurve<2> circle;
+    for(unsigned int i = 0; i < 9; i++)
+        circle.Add(center + points[i].x * x + points[i].y * y, i % 2 ? corner : 1.0f);
+
+    const float knots[12] = { 0, 0, 0, 0.25f, 0.25f, 0.5f, 0.5f, 0.75f, 0.75f, 1, 1, 1 };
+    circle.Knots.assign(knots, knots + 12);
+    return circle;
+}
+#endif
@@ -7,17 +7,31 @@
 #include <glm/gtx/vector_angle.hpp>
 #include <glm/gtx/spline.hpp>
 #include <glm/gtc/noise.hpp>
-#include <queue>
 
+#include <learnopengl/camera_clock.h>
+#include <learnopengl/camera_collider.h>
+#include <learnopengl/camera_layers.h>
+#include <learnopengl/camera_matrices.h>
+#include <learnopengl/camera_noise.h>
+#include <learnopengl/camera_orientation.h>
+#include <learnopengl/camera_path.h>
+#include <learnopengl/camera_policy.h>
+#include <learnopengl/camera_pool.h>
+#include <learnopengl/camera_track.h>
+#include <learnopengl/camera_trajectory.h>
+#include <learnopengl/spline_path.h>
+
+#include <algorithm>
 #include <vector>
 
 struct lookAt {
     glm::vec3 Position;
     glm::vec3 InicialFront;
     glm::vec3 FinalFront;
+    orientationSlerp Rotation;
     float InicialTime;
     float FinalTime;
-    bool Ended;
+    bool Started;
 };
 
 struct translation {
@@ -25,7 +39,7 @@ struct translation {
     glm::vec3 Position;
     float InicialTime;
     float FinalTime;
-    bool Ended;
+    bool Started;
 };
 
 struct rotationRP {
@@ -37,7 +51,7 @@ struct rotationRP {
     glm::vec3 InicialFront;
     glm::vec3 InicialPosition;
     glm::vec3 InicialUp;
-    bool Ended;
+    bool Started;
 };
 
 struct rotationRA {
@@ -50,8 +64,9 @@ struct rotationRA {
     glm::vec3 InicialFront;
     glm::vec3 InicialPosition;
     glm::vec3 InicialUp;
+    axisRotor Rotor;
 
-    bool Ended;
+    bool Started;
 };
 
 struct spline {
@@ -61,6 +76,46 @@ struct spline {
     glm::vec3 p3;
     float InicialTime;
     float Time;
+    bool Started;
+};
+
+struct pathFollow {
+    const CameraPath *Path;
+    float LookAhead;            // distance ahead the orientation is read from, or < 0 to keep the orientation
+    float InicialTime;
+    float FinalTime;
+    bool Started;
+};
+
+struct splineFollow {
+    const SplinePath *Path;
+    unsigned int Cursor;
+    float InicialTime;
+    bool Started;
+};
+
+// QUEUE_MERGE: a new target replaces the one waiting, with the new duration
+inline bool MergeTransformation(lookAt &pending, const lookAt &l)
+{
+    pending.Position = l.Position;
+    pending.FinalTime = l.FinalTime;
+    return true;
+}
+
+inline bool MergeTransformation(translation &pending, const translation &t)
+{
+    pending.Position = t.Position;
+    pending.FinalTime = t.FinalTime;
+    return true;
+}
+
+// Plays either a trajectory file or a baked track
+struct trajectoryPlayback {
+    const CameraTrajectory *Trajectory;
+    trajectoryCursor Cursor;
+    const CameraTrack *Track;
+    unsigned int Key;
+    float InicialTime;
     bool Ended;
 };
 
@@ -89,6 +144,7 @@ public:
     glm::vec3 Up;
     glm::vec3 Right;
     glm::vec3 WorldUp;
+    glm::quat Orientation;
 
     // Camera options
     float MovementSpeed;
@@ -98,39 +154,45 @@ public:
     float Far;
 
     bool noiseActive;
+    cameraNoise Noise;
     float currTime;
 
-    std::queue<lookAt> lookAtQueue;
-    std::queue<translation> translationQueue;
-    std::queue<rotationRP> rotationRPQueue;
-    std::queue<rotationRA> rotationRAQueue;
-    std::queue<spline> bSplineQueue;
-    std::queue<spline> bezierQueue;
+    // Where GetViewMatrix reads the time from. Without a clock the camera only moves through advance() and evaluateAt()
+    CameraClock *Clock;
 
-    lookAt currLookAt;
-    translation currTranslation;
-    rotationRP currRP;
-    rotationRA currRA;
-    spline currBSpline;
-    spline currBezier;
+    // Obstacles the transformations can't move the camera through, or NULL. See camera_collider.h
+    const CameraCollider *Collider;
+    float CollisionRadius;
 
+    PoolQueue<lookAt> lookAtQueue;
+    PoolQueue<translation> translationQueue;
+    PoolQueue<rotationRP> rotationRPQueue;
+    PoolQueue<rotationRA> rotationRAQueue;
+    PoolQueue<spline> bSplineQueue;
+    PoolQueue<spline> bezierQueue;
+    PoolQueue<pathFollow> pathQueue;
+    PoolQueue<splineFollow> splineQueue;
+
+    trajectoryPlayback currPlayback;
 
     // Constructor with vectors
     Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f), float zoom = ZOOM, float near = NEAR, float far = FAR) : MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY)
     {
-        currLookAt.Ended = true;
-        currTranslation.Ended = true;
-        currRP.Ended = true;
-        currRA.Ended = true;
-        currBSpline.Ended = true;
-        currBezier.Ended = true;
+        currPlayback.Ended = true;
         noiseActive = false;
+        noiseOffset = glm::vec3(0);
+        noiseRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        currTime = 0;
+        Clock = NULL;
+        Collider = NULL;
+        CollisionRadius = 0.25f;
 
         Near = near;
         Far = far;
         Zoom = zoom;
         Position = position;
         WorldUp = up;
+        Up = up;
         Front = front;
 
         updateCameraVectors();
@@ -140,18 +202,18 @@ public:
         lookAt l;
         l.Position = P;
         l.FinalTime = time;
-        l.Ended = false;
+        l.Started = false;
 
-        lookAtQueue.push(l);
+        enqueue(lookAtQueue, l, LAYER_LOOKAT);
     }
 
     void Translate(glm::vec3 P, float time){
         translation t;
         t.Position = P;
         t.FinalTime = time;
-        t.Ended = false;
+        t.Started = false;
 
-        translationQueue.push(t);
+        enqueue(translationQueue, t, LAYER_TRANSLATION);
     }
 
     void rotateRP(glm::vec3 P, float angle, float time){
@@ -159,9 +221,9 @@ public:
         r.Point = P;
         r.Angle = angle;
         r.FinalTime = time;
-        r.Ended = false;
+        r.Started = false;
 
-        rotationRPQueue.push(r);
+        enqueue(rotationRPQueue, r, LAYER_RP);
     
     }
     
@@ -170,9 +232,9 @@ public:
         r.Axis = axis;
         r.Angle = angle;
         r.FinalTime = time;
-        r.Ended = false;
+        r.Started = false;
 
-        rotationRAQueue.push(r);
+        enqueue(rotationRAQueue, r, LAYER_RA);
     }
 
     void bSplinePath(glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
@@ -182,9 +244,9 @@ public:
         b.p2 = P2;
         b.p3 = P3;
         b.Time = time;
-        b.Ended = false;
+        b.Started = false;
 
-        bSplineQueue.push(b);
+        enqueue(bSplineQueue, b, LAYER_BSPLINE);
     }
 
     void bezierPath(glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
@@ -194,57 +256,289 @@ public:
         b.p2 = P2;
         b.p3 = P3;
         b.Time = time;
-        b.Ended = false;
+        b.Started = false;
+
+        enqueue(bezierQueue, b, LAYER_BEZIER);
+    }
+
+    // Moves along a prebuilt path at constant speed. With orient the camera also looks along the path, using
+    // the path's rotation-minimizing frames read lookAhead units further on.
+    // The path is not copied, it must outlive the transformation
+    void followPath(const CameraPath *path, float time, bool orient = false, float lookAhead = 0.0f){
+        pathFollow p;
+        p.Path = path;
+        p.LookAhead = orient ? std::max(lookAhead, 0.0f) : -1.0f;
+        p.FinalTime = time;
+        p.Started = false;
+
+        enqueue(pathQueue, p, LAYER_PATH);
+    }
+
+    // Follows a spline path with any number of points, using the path's own segment times.
+    // The path is not copied, it must outlive the transformation
+    void followSpline(const SplinePath *path){
+        splineFollow s;
+        s.Path = path;
+        s.Cursor = 0;
+        s.Started = false;
+
+        enqueue(splineQueue, s, LAYER_SPLINE);
+    }
+
+    // Plays a recorded trajectory from now on. While it plays the pose comes only from the file and the queued
+    // transformations wait; it stops on the last frame, or at a damaged block. The trajectory must outlive the playback
+    void playTrajectory(const CameraTrajectory *trajectory){
+        currPlayback.Trajectory = trajectory;
+        currPlayback.Cursor = trajectoryCursor();
+        currPlayback.Track = NULL;
+        currPlayback.InicialTime = currTime;
+        currPlayback.Ended = !trajectory || trajectory->Frames() == 0;
+    }
+
+    // Plays a baked track from now on, the same way as playTrajectory. The track must outlive the playback
+    void playTrack(const CameraTrack *track){
+        currPlayback.Trajectory = NULL;
+        currPlayback.Track = track;
+        currPlayback.Key = 0;
+        currPlayback.InicialTime = currTime;
+        currPlayback.Ended = !track || track->Keys() == 0;
+    }
+
+    void stopTrajectory(){
+        currPlayback.Ended = true;
+    }
+
+    // Runs the queued transformations once, on a copy of the camera, and bakes them into a keyframe every
+    // 1 / sampleRate seconds for duration seconds from the camera's current time. The camera itself doesn't change
+    CameraTrack bakeTrack(float duration, float sampleRate) const {
+        Camera c = *this;
+        c.Clock = NULL;
+        c.currPlayback.Ended = true;
+
+        CameraTrack track;
+        track.Near = Near;
+        track.Far = Far;
+        double start = currTime;
+        unsigned int frames = (unsigned int)(duration * sampleRate) + 1;
+        for(unsigned int i = 0; i < frames; i++){
+            double time = i / (double)sampleRate;
+            c.evaluateAt((float)(start + time));
+            track.Add((float)time, c.Position, c.Orientation, c.Zoom);
+        }
+        return track;
+    }
+
+    // Evaluates the camera sampleRate times per second for duration seconds from its current time and writes
+    // the poses (without noise) to a trajectory file. The transformations run, so the camera ends duration seconds later
+    bool exportTrajectory(const char *path, float duration, float sampleRate, float positionStep = 1.0f / 1024.0f){
+        TrajectoryWriter writer;
+        if(!writer.Open(path, sampleRate, positionStep))
+            return false;
+
+        double start = currTime;
+        unsigned int frames = (unsigned int)(duration * sampleRate) + 1;
+        for(unsigned int i = 0; i < frames; i++){
+            evaluateAt((float)(start + i / (double)sampleRate));
+            writer.Add(Position, Orientation, Zoom, Near, Far);
+        }
+        return writer.Close();
+    }
+
+    // Puts the camera in a recorded pose, e.g. when replaying a recording
+    void setPose(const trajectoryPose &pose){
+        Position = pose.Position;
+        Orientation = pose.Orientation;
+        Zoom = pose.Zoom;
+        Near = pose.Near;
+        Far = pose.Far;
+        updateFromOrientation();
+    }
+
+    // Puts the camera at a position and orientation, keeping its lens, e.g. from a CameraGroup
+    void setPose(glm::vec3 position, glm::quat orientation){
+        Position = position;
+        Orientation = orientation;
+        updateFromOrientation();
+    }
+
+    // Blend weight of a layer, from 0 (no effect) to 1 (replaces the layers below it). See camera_layers.h
+    void setLayerWeight(CameraLayer layer, float weight){
+        layers.SetWeight(layer, weight);
+    }
+
+    // Layers with a higher priority are applied later, on top of the lower ones
+    void setLayerPriority(CameraLayer layer, int priority){
+        layers.SetPriority(layer, priority);
+    }
+
+    const cameraLayer &getLayer(CameraLayer layer) const {
+        return layers.Layers[layer];
+    }
+
+    // How a layer's queue treats new transformations, see camera_policy.h. maxDepth bounds the waiting ones (0 = no limit)
+    void setQueuePolicy(CameraLayer layer, QueuePolicy policy, unsigned int maxDepth = 0){
+        policies[layer].Policy = policy;
+        policies[layer].MaxDepth = maxDepth;
+    }
 
-        bezierQueue.push(b);
+    const queuePolicy &getQueuePolicy(CameraLayer layer) const {
+        return policies[layer];
+    }
+
+    // Layers with transformations running or queued, one bit per layer in priority order
+    unsigned int activeLayers() const {
+        return layers.Active;
+    }
+
+    // The Bezier (LAYER_BEZIER) or B-spline (LAYER_BSPLINE) path running on the camera and how far along
+    // it the camera was at its last evaluation, from 0 to 1. False when that layer has no path running
+    bool runningCurve(CameraLayer layer, spline &curve, float &fraction) const {
+        if(layer != LAYER_BEZIER && layer != LAYER_BSPLINE)
+            return false;
+        const PoolQueue<spline> &queue = layer == LAYER_BEZIER ? bezierQueue : bSplineQueue;
+        if(queue.empty() || !queue.front().Started)
+            return false;
+        curve = queue.front();
+        fraction = curve.Time > curve.InicialTime ? glm::clamp((currTime - curve.InicialTime) / (curve.Time - curve.InicialTime), 0.0f, 1.0f) : 1.0f;
+        return true;
+    }
+
+    // Shakes the view with Perlin noise on top of the transformations. The camera's Position and Orientation
+    // are not changed, only the view matrix is. Cameras with different phases don't shake in sync
+    void StartNoise(float amplitude, float rotationAmplitude, float frequency = 1.0f, unsigned int octaves = 3, float phase = 0.0f){
+        Noise.Amplitude = amplitude;
+        Noise.RotationAmplitude = rotationAmplitude;
+        Noise.Frequency = frequency;
+        Noise.Octaves = octaves;
+        Noise.Phase = phase;
+        noiseActive = true;
+    }
+
+    void StopNoise(){
+        noiseActive = false;
+        noiseOffset = glm::vec3(0);
+        noiseRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    // Moves the camera's time forward by dt seconds and applies the transformations
+    void advance(float dt){
+        evaluateAt(currTime + dt);
+    }
+
+    // Applies the transformations at an absolute time, in seconds
+    void evaluateAt(float time){
+        currTime = time;
+        if(!currPlayback.Ended)
+            ProcessPlayback();
+        else {
+            glm::vec3 from = Position;
+            ProcessTransformations();
+            if(Collider && Position != from)
+                Position = Collider->Move(from, Position, CollisionRadius);
+        }
+        if(noiseActive){
+            Noise.Evaluate(currTime, noiseOffset, noiseRotation);
+            float weight = layers.Layers[LAYER_NOISE].Weight;
+            if(weight != 1.0f){
+                noiseOffset *= weight;
+                noiseRotation = glm::slerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), noiseRotation, weight);
+            }
+        }
     }
 
-    // Returns the view matrix calculated using Euler Angles and the LookAt Matrix
+    // Returns the view matrix calculated from the orientation quaternion, after
+    // bringing the camera up to its clock's time (if it has one).
+    // The matrix is cached and only rebuilt when the position or orientation changed
     glm::mat4 GetViewMatrix()
     {
-        ProcessTransformations();
-        return glm::lookAt(Position, Position + Front, Up);
+        if(Clock)
+            evaluateAt(Clock->Now());
+        return matrices.GetView(Position + Orientation * noiseOffset, Orientation * noiseRotation);
     }
 
-    // Returns projection matrix for width and height screen values
+    // Returns projection matrix for width and height screen values, cached like the view matrix
     glm::mat4 GetProjectionMatrix(float width, float height)
     {
-        return glm::perspective(glm::radians(Zoom), (float)width / (float)height, Near, Far);
+        return matrices.GetProjection(Zoom, (float)width / (float)height, Near, Far);
+    }
+
+    // Returns projection * view, rebuilt only when one of them changed
+    glm::mat4 GetViewProjectionMatrix(float width, float height)
+    {
+        if(Clock)
+            evaluateAt(Clock->Now());
+        return matrices.GetViewProjection(Position + Orientation * noiseOffset, Orientation * noiseRotation, Zoom, (float)width / (float)height, Near, Far);
     }
 
 
 private:
+    cameraMatrices matrices;
+
+    // Noise offsets as of the last evaluation, in the camera's frame
+    glm::vec3 noiseOffset;
+    glm::quat noiseRotation;
 
+    // Weights and priorities of the layers, and which ones have transformations running or queued
+    cameraLayers layers;
+    queuePolicy policies[CAMERA_LAYERS];
+
+    typedef void (Camera::*layerProcessor)();
+
+    // Runs the active layers in priority order, each one blended by its weight over the pose the
+    // layers below it left. An idle camera has no active bits and does nothing
     void ProcessTransformations(){
-        currTime = glfwGetTime();
-        ProcessBSPline();
-        ProcessBezier();
-        processTranslation();
+        static const layerProcessor processors[CAMERA_LAYERS] = {
+            &Camera::ProcessBSPline, &Camera::ProcessBezier, &Camera::ProcessPath, &Camera::ProcessSpline,
+            &Camera::processTranslation, &Camera::ProcessRP, &Camera::ProcessRA, &Camera::ProcessLookAt, NULL
+        };
+
+        for(unsigned int active = layers.Active; active; active &= active - 1){
+            unsigned int layer = layers.Order[LowestBit(active)];
+            glm::vec3 position = Position;
+            glm::quat orientation = Orientation;
+
+            (this->*processors[layer])();
+
+            float weight = layers.Layers[layer].Weight;
+            if(weight != 1.0f){
+                Position = glm::mix(position, Position, weight);
+                Orientation = glm::slerp(orientation, Orientation, weight);
+                updateFromOrientation();
+            }
+        }
+    }
 
-        ProcessRP();
-        ProcessRA();
+    void ProcessPlayback(){
+        float time = currTime - currPlayback.InicialTime;
+        const CameraTrack *track = currPlayback.Track;
+        if(time >= (track ? track->Duration() : currPlayback.Trajectory->Duration()))
+            currPlayback.Ended = true;
 
-        ProcessLookAt();
+        if(track)
+            setPose(track->Sample(time, currPlayback.Key));
+        else {
+            trajectoryPose pose = currPlayback.Trajectory->Sample(time, currPlayback.Cursor);
+            // a damaged file stops the playback on the last frame before the damage
+            if(currPlayback.Cursor.Damaged)
+                currPlayback.Ended = true;
+            if(currPlayback.Cursor.Valid)
+                setPose(pose);
+        }
     }
 
     void ProcessBSPline(){
-        if(currBSpline.Ended){
-            if(!bSplineQueue.empty()){
-                currBSpline = bSplineQueue.front();
-                currBSpline.InicialTime = currTime;
-                currBSpline.Time += currTime;
-                currBSpline.Ended = false;
-                bSplineQueue.pop();
-            }
-            else {
-                return;
-            }
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        spline &currBSpline = bSplineQueue.front();
+        if(!currBSpline.Started){
+            currBSpline.InicialTime = currTime;
+            currBSpline.Time += currTime;
+            currBSpline.Started = true;
         }
         
         spline b = currBSpline;
-        float percentage = (this->currTime - b.InicialTime) / (b.Time - b.InicialTime);
+        float percentage = b.Time > b.InicialTime ? (this->currTime - b.InicialTime) / (b.Time - b.InicialTime) : 1;
         if(percentage >= 1){
-            currBSpline.Ended = true;
+            finish(bSplineQueue, LAYER_BSPLINE);
             Position = b.p3;
             return;
         }
@@ -265,32 +559,25 @@ private:
         Position = v;
     }
 
-    glm::vec3 Bezier(spline b, float t){
-        return (float)pow(1-t, 3) * b.p0 + 
-               3 * (float)pow(1-t, 2) * t * b.p1 +
-               3 * (1-t) * (float)pow(t, 2) * b.p2 +
-               (float)pow(t, 3) * b.p3;
+    glm::vec3 Bezier(const spline &b, float t){
+        glm::vec3 p[4] = { b.p0, b.p1, b.p2, b.p3 };
+        return DeCasteljau<3>(p, t);
     }
 
     void ProcessBezier(){
-        if(currBezier.Ended){
-            if(!bezierQueue.empty()){
-                currBezier = bezierQueue.front();
-                currBezier.InicialTime = currTime;
-                currBezier.Time += currTime;
-                currBezier.Ended = false;
-                bezierQueue.pop();
-            }
-            else {
-                return;
-            }
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        spline &currBezier = bezierQueue.front();
+        if(!currBezier.Started){
+            currBezier.InicialTime = currTime;
+            currBezier.Time += currTime;
+            currBezier.Started = true;
         }
         
         spline b = currBezier;
-        float percentage = (this->currTime - b.InicialTime) / (b.Time - b.InicialTime);
+        float percentage = b.Time > b.InicialTime ? (this->currTime - b.InicialTime) / (b.Time - b.InicialTime) : 1;
         if(percentage >= 1){
-            currBezier.Ended = true;
-            Position = currBezier.p3;
+            finish(bezierQueue, LAYER_BEZIER);
+            Position = b.p3;
             return;
         }
         else {
@@ -298,92 +585,103 @@ private:
         }
     }
 
-    void ProcessRA(){
-         if(currRA.Ended){
-            if(!rotationRAQueue.empty()){
-                currRA = rotationRAQueue.front();
-                currRA.Ended = false;   
-                currRA.InicialTime = currTime;
-                currRA.FinalTime += currTime;
-
-                currRA.InicialFront = Front;
-                currRA.InicialPosition = Position;
-                currRA.InicialUp = Up;
-                rotationRAQueue.pop(); 
-            }
-            else {
-                return;
-            }
+    void ProcessPath(){
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        pathFollow &currPath = pathQueue.front();
+        if(!currPath.Started){
+            currPath.InicialTime = currTime;
+            currPath.FinalTime += currTime;
+            currPath.Started = true;
         }
 
-        rotationRA r = currRA;
-        float percentage = (currTime - r.InicialTime) / (r.FinalTime - r.InicialTime);
+        pathFollow p = currPath;
+        float percentage = p.FinalTime > p.InicialTime ? (currTime - p.InicialTime) / (p.FinalTime - p.InicialTime) : 1;
         if(percentage >= 1){
             percentage = 1;
-            currRA.Ended = true;
+            finish(pathQueue, LAYER_PATH);
         }
-    
-        float angle;
-        angle = r.Angle * percentage;
-        glm::mat4 rotate;
-        rotate = glm::rotate(glm::mat4(1), angle, r.Axis);
-        
-        glm::vec4 newPosition = glm::vec4(r.InicialPosition, 1);
-        newPosition = newPosition * rotate;
-        glm::vec4 newFront = glm::vec4((r.InicialPosition + r.InicialFront), 1);
-        newFront = newFront * rotate;
-        glm::vec4 newUp = glm::vec4((r.InicialPosition + r.InicialUp), 1);
-        newUp = newUp * rotate;
 
-        Position = glm::vec3(newPosition.x, newPosition.y, newPosition.z);
-        Front = glm::vec3(newFront.x, newFront.y, newFront.z) - Position;
-        Up = glm::vec3(newUp.x, newUp.y, newUp.z) - Position;
-        Position = r.InicialPosition;
+        Position = p.Path->Sample(percentage);
+        if(p.LookAhead >= 0){
+            Orientation = p.Path->SampleOrientation(percentage + (p.Path->Length > 0 ? p.LookAhead / p.Path->Length : 0));
+            updateFromOrientation();
+        }
+    }
 
-        updateCameraVectors();
+    void ProcessSpline(){
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        splineFollow &currSpline = splineQueue.front();
+        if(!currSpline.Started){
+            currSpline.InicialTime = currTime;
+            currSpline.Started = true;
+        }
 
-        return;
+        float time = currTime - currSpline.InicialTime;
+        Position = currSpline.Path->Evaluate(time, currSpline.Cursor);
+        if(time >= currSpline.Path->Duration())
+            finish(splineQueue, LAYER_SPLINE);
     }
 
-    void ProcessRP(){
-        if(currRP.Ended){
-            if(!rotationRPQueue.empty()){
-                currRP = rotationRPQueue.front();
-                currRP.Ended = false;   
-                currRP.InicialTime = currTime;
-                currRP.FinalTime += currTime;
-
-                currRP.InicialFront = Front;
-                currRP.InicialPosition = Position;
-                currRP.InicialUp = Up;
-
-                glm::vec3 newFront;
-                if(currRP.Point != Position)
-                    newFront = currRP.Point - Position;
-                else
-                    newFront = Front;
-
-                newFront = glm::normalize(newFront);
-                if(newFront != Front && (newFront + Front) != glm::vec3(0)){
-                    Up = glm::normalize(glm::cross(Front, newFront));
-                    if(Up.y <= 0.0)    
-                        Up *= -1;
-                }
-
-                rotationRPQueue.pop(); 
+    void ProcessRA(){
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        rotationRA &currRA = rotationRAQueue.front();
+        if(!currRA.Started){
+            currRA.InicialTime = currTime;
+            currRA.FinalTime += currTime;
+
+            currRA.InicialFront = Front;
+            currRA.InicialPosition = Position;
+            currRA.InicialUp = Up;
+            currRA.Rotor.Set(Orientation, currRA.Axis);
+            currRA.Started = true;
+        }
 
+        float percentage = currRA.FinalTime > currRA.InicialTime ? (currTime - currRA.InicialTime) / (currRA.FinalTime - currRA.InicialTime) : 1;
+
+        // the angle is negated to keep the direction of the original row-vector rotation matrix
+        if(percentage >= 1){
+            Orientation = currRA.Rotor.Exact(-currRA.Angle);
+            finish(rotationRAQueue, LAYER_RA);
+        }
+        else {
+            Orientation = currRA.Rotor.Advance(-currRA.Angle * percentage);
+        }
+
+        updateFromOrientation();
+    }
+
+    void ProcessRP(){
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        rotationRP &currRP = rotationRPQueue.front();
+        if(!currRP.Started){
+            currRP.InicialTime = currTime;
+            currRP.FinalTime += currTime;
+
+            currRP.InicialFront = Front;
+            currRP.InicialPosition = Position;
+            currRP.InicialUp = Up;
+
+            glm::vec3 newFront;
+            if(currRP.Point != Position)
+                newFront = currRP.Point - Position;
+            else
+                newFront = Front;
+
+            newFront = glm::normalize(newFront);
+            if(newFront != Front && (newFront + Front) != glm::vec3(0)){
+                Up = glm::normalize(glm::cross(Front, newFront));
+                if(Up.y <= 0.0)    
+                    Up *= -1;
             }
-            else {
-                return;
-            }
+            currRP.Started = true;
         }
         
 
         rotationRP r = currRP;
-        float percentage = (currTime - r.InicialTime) / (r.FinalTime - r.InicialTime);
+        float percentage = r.FinalTime > r.InicialTime ? (currTime - r.InicialTime) / (r.FinalTime - r.InicialTime) : 1;
         if(percentage >= 1){
             percentage = 1;
-            currRP.Ended = true;
+            finish(rotationRPQueue, LAYER_RP);
         }
     
         float angle;
@@ -404,72 +702,81 @@ private:
     }
 
     void processTranslation(){
-        if(currTranslation.Ended){
-            if(!translationQueue.empty()){
-                currTranslation = translationQueue.front();
-                translationQueue.pop();
-
-                currTranslation.InicialTime = currTime;
-                currTranslation.FinalTime += currTime;
-                currTranslation.Ended = false;
-                currTranslation.InicialPosition = Position;
-            }
-            else 
-                return;
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        translation &currTranslation = translationQueue.front();
+        if(!currTranslation.Started){
+            currTranslation.InicialTime = currTime;
+            currTranslation.FinalTime += currTime;
+            currTranslation.InicialPosition = Position;
+            currTranslation.Started = true;
         }
 
         translation t = currTranslation;
-        float percentage = (currTime - t.InicialTime) / (t.FinalTime - t.InicialTime);
+        float percentage = t.FinalTime > t.InicialTime ? (currTime - t.InicialTime) / (t.FinalTime - t.InicialTime) : 1;
 
         if(percentage >= 1){
             percentage = 1.0f;
-            currTranslation.Ended = true;
+            finish(translationQueue, LAYER_TRANSLATION);
         }
 
         this->Position = t.InicialPosition + percentage * (t.Position - t.InicialPosition);
     }
 
     void ProcessLookAt(){
-        if(currLookAt.Ended){
-            if(!lookAtQueue.empty()){
-                currLookAt = lookAtQueue.front();
-                lookAtQueue.pop();
-                
-                if(Position == currLookAt.Position){
-                    currLookAt.Ended = true;
-                    return;
-                }
-
-                currLookAt.InicialTime = currTime;
-                currLookAt.FinalTime += currTime;
-                currLookAt.Ended = false;
-                currLookAt.InicialFront = Front;
-                currLookAt.FinalFront = glm::normalize(currLookAt.Position - Position);
-            }
-            else 
+        // the layer is active, so the queue isn't empty: its front is the transformation running
+        lookAt &currLookAt = lookAtQueue.front();
+        if(!currLookAt.Started){
+            if(Position == currLookAt.Position){
+                finish(lookAtQueue, LAYER_LOOKAT);
                 return;
+            }
+
+            currLookAt.InicialTime = currTime;
+            currLookAt.FinalTime += currTime;
+            currLookAt.InicialFront = Front;
+            currLookAt.FinalFront = glm::normalize(currLookAt.Position - Position);
+            currLookAt.Rotation.Set(Orientation, OrientationFromVectors(currLookAt.FinalFront, WorldUp, Up));
+            currLookAt.Started = true;
         }
 
-        lookAt t = currLookAt;
-        float percentage = (currTime - t.InicialTime) / (t.FinalTime - t.InicialTime);
+        float percentage = currLookAt.FinalTime > currLookAt.InicialTime ? (currTime - currLookAt.InicialTime) / (currLookAt.FinalTime - currLookAt.InicialTime) : 1;
 
-        if(percentage >= 1){
-            percentage = 1.0f;
-            currLookAt.Ended = true;
-        }
+        bool ended = percentage >= 1;
+        Orientation = currLookAt.Rotation.At(ended ? 1.0f : percentage);
+        updateFromOrientation();
+        if(ended)
+            finish(lookAtQueue, LAYER_LOOKAT);
+    }
 
-        Front = t.InicialFront + percentage * (t.FinalFront - t.InicialFront);
-        updateCameraVectors();
+    template <typename T>
+    void enqueue(PoolQueue<T> &queue, const T &value, CameraLayer layer){
+        EnqueueTransformation(queue, value, policies[layer]);
+        layers.Activate(layer);
+    }
 
+    // Drops the finished transformation at the front of a queue; the layer goes idle when nothing else is queued
+    template <typename T>
+    void finish(PoolQueue<T> &queue, CameraLayer layer){
+        queue.pop();
+        if(queue.empty())
+            layers.Deactivate(layer);
     }
 
     // Calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
     {
         Front = glm::normalize(Front);
-        // Also re-calculate the Right and Up vector
-        Right = glm::normalize(glm::cross(Front, WorldUp));  // Normalize the vectors, because their length gets closer to 0 the more you look up or down which results in slower movement.
-        Up    = glm::normalize(glm::cross(Right, Front));
+        // Falls back to the current Up when looking straight along WorldUp, where their cross product vanishes
+        Orientation = OrientationFromVectors(Front, WorldUp, Up);
+        updateFromOrientation();
+    }
+
+    // Re-calculates the Front, Right and Up vectors from the orientation quaternion
+    void updateFromOrientation()
+    {
+        Front = Orientation * glm::vec3(0.0f, 0.0f, -1.0f);
+        Right = Orientation * glm::vec3(1.0f, 0.0f, 0.0f);
+        Up    = Orientation * glm::vec3(0.0f, 1.0f, 0.0f);
     }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,68 @@
+#ifndef CAMERA_CLOCK_H
+#define CAMERA_CLOCK_H
+
+// Source of the time, in seconds, that a camera uses for its transformations.
+// Cameras never read the window system's timer themselves, so they can be simulated without a window.
+class CameraClock
+{
+public:
+    virtual ~CameraClock() {}
+    virtual float Now() = 0;
+};
+
+// Reads the time from a function, e.g. FunctionClock clock(glfwGetTime);
+class FunctionClock : public CameraClock
+{
+public:
+    typedef double (*TimeFunction)();
+
+    FunctionClock(TimeFunction function) : function(function) {}
+
+    float Now() {
+        return (float)function();
+    }
+
+private:
+    TimeFunction function;
+};
+
+// Time that only moves when told to
+class ManualClock : public CameraClock
+{
+public:
+    float Time;
+
+    ManualClock(float time = 0.0f) : Time(time) {}
+
+    float Now() {
+        return Time;
+    }
+
+    void Set(float time) {
+        Time = time;
+    }
+
+    void Advance(float dt) {
+        Time += dt;
+    }
+};
+
+// Fixed-step time: the time is always Steps * Step, so a run with the same number of steps
+// ends at exactly the same time however long it is (no rounding error builds up from adding dt).
+class FixedStepClock : public CameraClock
+{
+public:
+    float Step;
+    unsigned long long Steps;
+
+    FixedStepClock(float step = 1.0f / 60.0f) : Step(step), Steps(0) {}
+
+    float Now() {
+        return (float)(Steps * (double)Step);
+    }
+
+    void Tick(unsigned long long steps = 1) {
+        Steps += steps;
+    }
+};
+#endif
@@ -0,0 +1,17 @@
+#ifndef CAMERA_COLLIDER_H
+#define CAMERA_COLLIDER_H
+
+#include <glm/glm.hpp>
+
+// Keeps cameras out of obstacles. A camera with a collider is a sphere of CollisionRadius: each time its
+// transformations move it, it goes from where it was towards where they put it and stops, or slides, at
+// the first obstacle in the way. See camera_collision.h for the scene geometry one.
+class CameraCollider
+{
+public:
+    virtual ~CameraCollider() {}
+    // Where a sphere moving from one point to another ends up. Called from several threads at once by
+    // CameraSystem::Update, so it must not change the collider
+    virtual glm::vec3 Move(glm::vec3 from, glm::vec3 to, float radius) const = 0;
+};
+#endif
@@ -0,0 +1,579 @@
+#ifndef CAMERA_COLLISION_H
+#define CAMERA_COLLISION_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera_collider.h>
+#include <learnopengl/mesh_geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// Bounding volume hierarchy over the triangles of a scene, for sphere sweeps. The tree is built with the
+// surface area heuristic over binned centroids, its nodes are laid out depth first (the left child right
+// after its parent) in 32 bytes each, and the triangles are stored in leaf order, so a query walks two
+// flat arrays. Building runs the upper levels' subtrees on separate threads, and the result can be saved
+// and loaded again as is, checked against a key of the geometry it was built from.
+//
+// Cache files are a bvhHeader, the nodes, then the triangles. All little-endian.
+
+const uint32_t BVH_VERSION = 1;
+
+// What BuildOrLoad did
+enum BvhCacheResult {
+    BVH_LOADED,             // from the cache file
+    BVH_SAVED,              // built, and saved to the cache file
+    BVH_NOT_SAVED           // built, but the cache file couldn't be written
+};
+
+struct bvhHeader {
+    char Magic[4];              // "CBVH"
+    uint32_t Version;
+    uint64_t Key;               // GeometryKey of the scene
+    uint32_t Nodes;
+    uint32_t Triangles;
+};
+
+struct bvhNode {
+    glm::vec3 Min;
+    uint32_t First;             // leaves: first triangle; inner nodes: right child (the left one is next)
+    glm::vec3 Max;
+    uint32_t Count;             // triangles of a leaf, 0 for inner nodes
+};
+
+struct bvhTriangle {
+    glm::vec3 P[3];
+};
+
+// First contact of a sweep
+struct sweepHit {
+    float Time;                 // fraction of the way, 0 when the sphere starts touching
+    glm::vec3 Normal;           // away from the triangle, at the contact
+    unsigned int Triangle;
+};
+
+// Hash of the world-space geometry: changes when a mesh, an index or a model matrix does
+inline uint64_t GeometryKey(const std::vector<occluderModel> &models)
+{
+    uint64_t h = 14695981039346656037ull;
+    struct fnv {
+        static void Add(uint64_t &h, const void *data, size_t size){
+            const unsigned char *p = (const unsigned char *)data;
+            for(size_t i = 0; i < size; i++)
+                h = (h ^ p[i]) * 1099511628211ull;
+        }
+    };
+    for(unsigned int m = 0; m < models.size(); m++){
+        fnv::Add(h, &models[m].Transform, sizeof(glm::mat4));
+        for(unsigned int i = 0; i < models[m].Meshes.size(); i++){
+            const occluderMesh &mesh = models[m].Meshes[i];
+            for(unsigned int v = 0; v < mesh.Vertices; v++){
+                glm::vec3 p = OccluderVertex(mesh, v);
+                fnv::Add(h, &p, sizeof(p));
+            }
+            if(mesh.IndexCount)
+                fnv::Add(h, mesh.Indices, mesh.IndexCount * sizeof(unsigned int));
+        }
+    }
+    return h;
+}
+
+class TriangleBVH
+{
+public:
+    static const unsigned int BINS = 16;
+    static const unsigned int LEAF_SIZE = 4;        // never split below this
+    static const unsigned int MAX_LEAF_SIZE = 16;   // always split above this
+    static const unsigned int PARALLEL_SIZE = 8192; // smaller subtrees are built on the thread that got them
+    static const unsigned int MAX_DEPTH = 60;       // deeper nodes are leaves, so a query's stack never overflows
+
+    std::vector<bvhNode> Nodes;
+    std::vector<bvhTriangle> Triangles;
+
+    // Builds the tree over every triangle of the models, in world space. threads = 0 uses every hardware thread
+    void Build(const std::vector<occluderModel> &models, unsigned int threads = 0)
+    {
+        std::vector<bvhTriangle> triangles;
+        for(unsigned int m = 0; m < models.size(); m++)
+            for(unsigned int i = 0; i < models[m].Meshes.size(); i++){
+                const occluderMesh &mesh = models[m].Meshes[i];
+                for(unsigned int k = 0; k + 2 < mesh.IndexCount; k += 3){
+                    bvhTriangle t;
+                    for(unsigned int c = 0; c < 3; c++)
+                        t.P[c] = glm::vec3(models[m].Transform * glm::vec4(OccluderVertex(mesh, mesh.Indices[k + c]), 1.0f));
+                    triangles.push_back(t);
+                }
+            }
+        Build(triangles, threads);
+    }
+
+    void Build(const std::vector<bvhTriangle> &triangles, unsigned int threads = 0)
+    {
+        Nodes.clear();
+        Triangles.clear();
+        if(triangles.empty())
+            return;
+
+        buildData data;
+        data.Triangles = &triangles;
+        data.Centroids.resize(triangles.size());
+        data.Indices.resize(triangles.size());
+        for(unsigned int i = 0; i < triangles.size(); i++){
+            data.Centroids[i] = (triangles[i].P[0] + triangles[i].P[1] + triangles[i].P[2]) / 3.0f;
+            data.Indices[i] = i;
+        }
+
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        build(&data, 0, (unsigned int)triangles.size(), &Nodes, threads, 0);
+
+        Triangles.resize(triangles.size());
+        for(unsigned int i = 0; i < triangles.size(); i++)
+            Triangles[i] = triangles[data.Indices[i]];
+    }
+
+    bool Empty() const {
+        return Nodes.empty();
+    }
+
+    // Whether a sphere of radius moving from p0 to p1 touches a triangle on the way, and where first.
+    // Triangles the sphere already touches at p0 only count if it moves further into them
+    bool SweepSphere(glm::vec3 p0, glm::vec3 p1, float radius, sweepHit &hit) const
+    {
+        if(Nodes.empty())
+            return false;
+
+        glm::vec3 d = p1 - p0;
+        glm::vec3 inv;
+        for(unsigned int a = 0; a < 3; a++)
+            inv[a] = 1.0f / (d[a] != 0 ? d[a] : 1e-30f);
+
+        hit.Time = 2.0f;
+        unsigned int stack[MAX_DEPTH + 4];
+        unsigned int top = 0;
+        stack[top++] = 0;
+        while(top){
+            const bvhNode &node = Nodes[stack[--top]];
+            if(!segmentBox(p0, inv, node.Min - radius, node.Max + radius, hit.Time))
+                continue;
+
+            if(node.Count){
+                for(unsigned int i = node.First; i < node.First + node.Count; i++)
+                    sweepTriangle(Triangles[i], p0, d, radius, i, hit);
+                continue;
+            }
+
+            // visits the nearer child first, so the farther one is more often skipped
+            unsigned int left = (unsigned int)(&node - &Nodes[0]) + 1, right = node.First;
+            unsigned int axis = std::fabs(d.x) > std::fabs(d.y) ? (std::fabs(d.x) > std::fabs(d.z) ? 0 : 2) : (std::fabs(d.y) > std::fabs(d.z) ? 1 : 2);
+            if(d[axis] < 0)
+                std::swap(left, right);
+            stack[top++] = right;
+            stack[top++] = left;
+        }
+        return hit.Time <= 1.0f;
+    }
+
+    bool Save(const char *path, uint64_t key) const
+    {
+        FILE *file = fopen(path, "wb");
+        if(!file)
+            return false;
+
+        bvhHeader header;
+        memcpy(header.Magic, "CBVH", 4);
+        header.Version = BVH_VERSION;
+        header.Key = key;
+        header.Nodes = (uint32_t)Nodes.size();
+        header.Triangles = (uint32_t)Triangles.size();
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && (Nodes.empty() || fwrite(&Nodes[0], sizeof(bvhNode), Nodes.size(), file) == Nodes.size());
+        ok = ok && (Triangles.empty() || fwrite(&Triangles[0], sizeof(bvhTriangle), Triangles.size(), file) == Triangles.size());
+        return fclose(file) == 0 && ok;
+    }
+
+    // Fails, leaving the tree unchanged, if the file can't be read or was built from other geometry
+    bool Load(const char *path, uint64_t key)
+    {
+        FILE *file = fopen(path, "rb");
+        if(!file)
+            return false;
+
+        bvhHeader header;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.Magic, "CBVH", 4) == 0;
+        ok = ok && header.Version == BVH_VERSION && header.Key == key && header.Nodes < (1u << 28) && header.Triangles < (1u << 28);
+
+        std::vector<bvhNode> nodes;
+        std::vector<bvhTriangle> triangles;
+        if(ok){
+            nodes.resize(header.Nodes);
+            triangles.resize(header.Triangles);
+            ok = nodes.empty() || fread(&nodes[0], sizeof(bvhNode), nodes.size(), file) == nodes.size();
+            ok = ok && (triangles.empty() || fread(&triangles[0], sizeof(bvhTriangle), triangles.size(), file) == triangles.size());
+        }
+        fclose(file);
+
+        // every link must stay inside the arrays, and the tree no deeper than Build makes it
+        std::vector<unsigned int> depth(nodes.size(), 0);
+        for(unsigned int i = 0; ok && i < nodes.size(); i++){
+            const bvhNode &n = nodes[i];
+            if(n.Count)
+                ok = n.First <= triangles.size() && n.Count <= triangles.size() - n.First;
+            else {
+                ok = n.First > i + 1 && n.First < nodes.size() && depth[i] < MAX_DEPTH;
+                if(ok){
+                    depth[i + 1] = std::max(depth[i + 1], depth[i] + 1);
+                    depth[n.First] = std::max(depth[n.First], depth[i] + 1);
+                }
+            }
+        }
+        if(!ok)
+            return false;
+
+        Nodes.swap(nodes);
+        Triangles.swap(triangles);
+        return true;
+    }
+
+    // Loads the tree from a cache file if it was built from these models, or builds it and saves it there
+    BvhCacheResult BuildOrLoad(const std::vector<occluderModel> &models, const char *path, unsigned int threads = 0)
+    {
+        uint64_t key = GeometryKey(models);
+        if(Load(path, key))
+            return BVH_LOADED;
+        Build(models, threads);
+        return Save(path, key) ? BVH_SAVED : BVH_NOT_SAVED;
+    }
+
+private:
+    struct buildData {
+        const std::vector<bvhTriangle> *Triangles;
+        std::vector<glm::vec3> Centroids;
+        std::vector<unsigned int> Indices;      // triangles in the order the leaves take them
+    };
+
+    struct bounds {
+        glm::vec3 Min;
+        glm::vec3 Max;
+
+        bounds() : Min(std::numeric_limits<float>::max()), Max(-std::numeric_limits<float>::max()) {}
+
+        void Add(glm::vec3 p){
+            Min = glm::min(Min, p);
+            Max = glm::max(Max, p);
+        }
+
+        void Add(const bounds &b){
+            Min = glm::min(Min, b.Min);
+            Max = glm::max(Max, b.Max);
+        }
+
+        float Area() const {
+            glm::vec3 e = Max - Min;
+            return e.x < 0 ? 0 : 2 * (e.x * e.y + e.y * e.z + e.z * e.x);
+        }
+    };
+
+    // Builds the subtree of triangles [begin, end) into nodes, which starts empty: its own indices are
+    // relative to it
+    static void build(buildData *data, unsigned int begin, unsigned int end, std::vector<bvhNode> *nodes, unsigned int threads, unsigned int depth)
+    {
+        const std::vector<bvhTriangle> &triangles = *data->Triangles;
+        bounds box, centroids;
+        for(unsigned int i = begin; i < end; i++){
+            const bvhTriangle &t = triangles[data->Indices[i]];
+            box.Add(t.P[0]);
+            box.Add(t.P[1]);
+            box.Add(t.P[2]);
+            centroids.Add(data->Centroids[data->Indices[i]]);
+        }
+
+        unsigned int self = (unsigned int)nodes->size();
+        bvhNode node;
+        node.Min = box.Min;
+        node.Max = box.Max;
+        node.First = begin;
+        node.Count = end - begin;
+        nodes->push_back(node);
+        if(end - begin <= LEAF_SIZE || depth == MAX_DEPTH)
+            return;
+
+        unsigned int middle = split(data, begin, end, box, centroids);
+        if(middle == begin || middle == end)
+            return;
+        (*nodes)[self].Count = 0;
+
+        if(threads > 1 && end - begin >= PARALLEL_SIZE){
+            std::vector<bvhNode> left, right;
+            std::thread worker(&TriangleBVH::build, data, begin, middle, &left, threads / 2, depth + 1);
+            build(data, middle, end, &right, threads - threads / 2, depth + 1);
+            worker.join();
+            append(*nodes, left);
+            (*nodes)[self].First = (unsigned int)nodes->size();
+            append(*nodes, right);
+        }
+        else {
+            std::vector<bvhNode> right;
+            build(data, begin, middle, nodes, 1, depth + 1);
+            (*nodes)[self].First = (unsigned int)nodes->size();
+            build(data, middle, end, &right, 1, depth + 1);
+            append(*nodes, right);
+        }
+    }
+
+    // Appends a subtree built on its own, moving its links to where it lands
+    static void append(std::vector<bvhNode> &nodes, const std::vector<bvhNode> &subtree)
+    {
+        unsigned int offset = (unsigned int)nodes.size();
+        for(unsigned int i = 0; i < subtree.size(); i++){
+            nodes.push_back(subtree[i]);
+            if(subtree[i].Count == 0)
+                nodes.back().First += offset;
+        }
+    }
+
+    // Partitions [begin, end) at the cheapest bin boundary by the surface area heuristic and returns where
+    // the right side starts: begin when a leaf is cheaper. Falls back to halves when the centroids coincide
+    static unsigned int split(buildData *data, unsigned int begin, unsigned int end, const bounds &box, const bounds &centroids)
+    {
+        const std::vector<bvhTriangle> &triangles = *data->Triangles;
+        unsigned int count = end - begin;
+        float bestCost = std::numeric_limits<float>::max();
+        unsigned int bestAxis = 3, bestBin = 0;
+
+        for(unsigned int axis = 0; axis < 3; axis++){
+            float lo = centroids.Min[axis], extent = centroids.Max[axis] - lo;
+            if(!(extent > 0))
+                continue;
+            float scale = BINS / extent;
+
+            bounds bins[BINS];
+            unsigned int counts[BINS] = { 0 };
+            for(unsigned int i = begin; i < end; i++){
+                unsigned int t = data->Indices[i];
+                unsigned int b = std::min((unsigned int)((data->Centroids[t][axis] - lo) * scale), BINS - 1);
+                counts[b]++;
+                bins[b].Add(triangles[t].P[0]);
+                bins[b].Add(triangles[t].P[1]);
+                bins[b].Add(triangles[t].P[2]);
+            }
+
+            // cost of splitting after bin b: area of each side times its triangles
+            float rightArea[BINS];
+            unsigned int rightCount[BINS];
+            bounds r;
+            unsigned int n = 0;
+            for(unsigned int b = BINS - 1; b > 0; b--){
+                r.Add(bins[b]);
+                n += counts[b];
+                rightArea[b] = r.Area();
+                rightCount[b] = n;
+            }
+            bounds l;
+            n = 0;
+            for(unsigned int b = 0; b + 1 < BINS; b++){
+                l.Add(bins[b]);
+                n += counts[b];
+                float cost = l.Area() * n + rightArea[b + 1] * rightCount[b + 1];
+                if(n > 0 && rightCount[b + 1] > 0 && cost < bestCost){
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        if(bestAxis == 3){
+            // every centroid in the same place: halves, unless small enough to stay a leaf
+            if(count <= MAX_LEAF_SIZE)
+                return begin;
+            return begin + count / 2;
+        }
+        if(count <= MAX_LEAF_SIZE && bestCost >= box.Area() * count)
+            return begin;
+
+        float lo = centroids.Min[bestAxis], scale = BINS / (centroids.Max[bestAxis] - lo);
+        unsigned int *first = &data->Indices[0] + begin, *last = &data->Indices[0] + end;
+        unsigned int *middle = std::partition(first, last, binBelow(data, bestAxis, lo, scale, bestBin));
+        return begin + (unsigned int)(middle - first);
+    }
+
+    struct binBelow {
+        const buildData *Data;
+        unsigned int Axis;
+        float Lo, Scale;
+        unsigned int Bin;
+
+        binBelow(const buildData *data, unsigned int axis, float lo, float scale, unsigned int bin) : Data(data), Axis(axis), Lo(lo), Scale(scale), Bin(bin) {}
+
+        bool operator()(unsigned int t) const {
+            return std::min((unsigned int)((Data->Centroids[t][Axis] - Lo) * Scale), BINS - 1) <= Bin;
+        }
+    };
+
+    // Whether the segment p0 + t (p1 - p0), 0 <= t <= maxTime, crosses the box. inv is 1 / (p1 - p0)
+    static bool segmentBox(glm::vec3 p0, glm::vec3 inv, glm::vec3 lo, glm::vec3 hi, float maxTime)
+    {
+        float t0 = 0, t1 = std::min(maxTime, 1.0f);
+        for(unsigned int a = 0; a < 3; a++){
+            float ta = (lo[a] - p0[a]) * inv[a], tb = (hi[a] - p0[a]) * inv[a];
+            if(ta > tb)
+                std::swap(ta, tb);
+            t0 = std::max(t0, ta);
+            t1 = std::min(t1, tb);
+            if(t0 > t1)
+                return false;
+        }
+        return true;
+    }
+
+    static void keep(sweepHit &hit, float time, glm::vec3 normal, unsigned int triangle)
+    {
+        if(time < hit.Time){
+            hit.Time = time;
+            hit.Normal = normal;
+            hit.Triangle = triangle;
+        }
+    }
+
+    // First time in [0, hit.Time) a point moving from p by d comes within radius of a sphere's center c,
+    // moving towards it. Returns false if it doesn't
+    static bool sweepPoint(glm::vec3 p, glm::vec3 d, glm::vec3 c, float radius, float &time)
+    {
+        glm::vec3 m = p - c;
+        float b = glm::dot(m, d), k = glm::dot(m, m) - radius * radius;
+        if(k <= 0){
+            time = 0;
+            return b < 0;
+        }
+        float a = glm::dot(d, d);
+        float disc = b * b - a * k;
+        if(b >= 0 || disc < 0 || a == 0)
+            return false;
+        time = (-b - std::sqrt(disc)) / a;
+        return true;
+    }
+
+    // Sphere of radius moving from p by d against a triangle: its face, then its edges (cylinders), then
+    // its corners (spheres)
+    static void sweepTriangle(const bvhTriangle &tri, glm::vec3 p, glm::vec3 d, float radius, unsigned int index, sweepHit &hit)
+    {
+        const glm::vec3 &a = tri.P[0], &b = tri.P[1], &c = tri.P[2];
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        if(!(length > 0))
+            return;
+        n /= length;
+        glm::vec3 face = n;         // wound like the triangle, for inside
+
+        // the face, from the side the sphere starts on
+        float distance = glm::dot(p - a, n);
+        if(distance < 0){
+            n = -n;
+            distance = -distance;
+        }
+        float approach = glm::dot(d, n);
+        float time = -1;
+        if(distance >= radius && approach < 0)
+            time = (distance - radius) / -approach;
+        else if(distance < radius && approach < 0)
+            time = 0;
+        if(time >= 0 && time < hit.Time){
+            // where the sphere touches the plane
+            glm::vec3 q = p + time * d - n * (time > 0 ? radius : distance);
+            if(inside(a, b, c, face, q)){
+                keep(hit, time, n, index);
+                return;
+            }
+        }
+
+        // the edges, where the sphere's center comes within radius of the segment
+        const glm::vec3 *corners[3] = { &a, &b, &c };
+        for(unsigned int i = 0; i < 3; i++){
+            glm::vec3 e0 = *corners[i], e = *corners[(i + 1) % 3] - e0;
+            float ee = glm::dot(e, e);
+            if(ee == 0)
+                continue;
+            glm::vec3 m = p - e0;
+            glm::vec3 mp = m - e * (glm::dot(m, e) / ee), dp = d - e * (glm::dot(d, e) / ee);
+            float qa = glm::dot(dp, dp), qb = glm::dot(mp, dp), qc = glm::dot(mp, mp) - radius * radius;
+            float t;
+            if(qc <= 0){
+                if(qb >= 0)
+                    continue;
+                t = 0;
+            }
+            else {
+                float disc = qb * qb - qa * qc;
+                if(qb >= 0 || disc < 0 || qa == 0)
+                    continue;
+                t = (-qb - std::sqrt(disc)) / qa;
+            }
+            if(t >= hit.Time)
+                continue;
+            float s = glm::dot(m + t * d, e) / ee;
+            if(s < 0 || s > 1)
+                continue;
+            glm::vec3 normal = m + t * d - e * s;
+            float nl = glm::length(normal);
+            keep(hit, t, nl > 0 ? normal / nl : n, index);
+        }
+
+        // the corners
+        for(unsigned int i = 0; i < 3; i++){
+            float t;
+            if(sweepPoint(p, d, *corners[i], radius, t) && t < hit.Time){
+                glm::vec3 normal = p + t * d - *corners[i];
+                float nl = glm::length(normal);
+                keep(hit, t, nl > 0 ? normal / nl : n, index);
+            }
+        }
+    }
+
+    // Whether q, on the triangle's plane, is inside it
+    static bool inside(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 n, glm::vec3 q)
+    {
+        return glm::dot(glm::cross(b - a, q - a), n) >= 0 && glm::dot(glm::cross(c - b, q - b), n) >= 0 && glm::dot(glm::cross(a - c, q - c), n) >= 0;
+    }
+};
+
+// Keeps cameras out of a static scene: a sweep through the BVH per move, sliding along what it hits so
+// a camera pushed against a wall moves along it instead of stopping dead
+class SceneCollider : public CameraCollider
+{
+public:
+    TriangleBVH Tree;
+    float Skin;                 // distance kept from the surfaces
+    unsigned int Slides;        // moves along surfaces after the first contact
+
+    SceneCollider(float skin = 0.001f, unsigned int slides = 2) : Skin(skin), Slides(slides) {}
+
+    glm::vec3 Move(glm::vec3 from, glm::vec3 to, float radius) const
+    {
+        glm::vec3 position = from, target = to;
+        for(unsigned int i = 0; i <= Slides; i++){
+            sweepHit hit;
+            if(!Tree.SweepSphere(position, target, radius, hit))
+                return target;
+
+            glm::vec3 move = target - position;
+            float length = glm::length(move);
+            position += move * std::max(hit.Time - Skin / length, 0.0f);
+
+            // what is left of the move, without the part going into the surface
+            glm::vec3 rest = target - position;
+            target = position + rest - hit.Normal * std::min(glm::dot(rest, hit.Normal), 0.0f);
+            if(glm::length(target - position) <= Skin)
+                return position;
+        }
+        return position;
+    }
+};
+#endif
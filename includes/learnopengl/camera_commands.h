@@ -0,0 +1,312 @@
+#ifndef CAMERA_COMMANDS_H
+#define CAMERA_COMMANDS_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_system.h>
+#include <learnopengl/slot_map.h>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+enum CameraCommandType {
+    COMMAND_LOOKAT,
+    COMMAND_TRANSLATE,
+    COMMAND_RP,
+    COMMAND_RA,
+    COMMAND_BSPLINE,
+    COMMAND_BEZIER,
+    COMMAND_PATH,
+    COMMAND_SPLINE,
+    COMMAND_NOISE_START,
+    COMMAND_NOISE_STOP
+};
+
+// One call to a camera's transformation methods, with its arguments. P[0] is the point (or the axis
+// of rotateRA), P[0..3] are the control points of the curves, and Value[] holds angle / amplitudes
+struct cameraCommand {
+    unsigned char Type;
+    unsigned int Camera;
+    glm::vec3 P[4];
+    float Value[4];
+    float Time;
+    unsigned int Octaves;
+    const CameraPath *Path;
+    const SplinePath *Spline;
+};
+
+inline cameraCommand CameraCommand(CameraCommandType type, unsigned int id, float time)
+{
+    cameraCommand c;
+    c.Type = (unsigned char)type;
+    c.Camera = id;
+    c.Time = time;
+    c.Octaves = 0;
+    c.Path = NULL;
+    c.Spline = NULL;
+    return c;
+}
+
+// One builder per transformation method, taking the same arguments with the camera id first
+inline cameraCommand LookAtCommand(unsigned int id, glm::vec3 P, float time){
+    cameraCommand c = CameraCommand(COMMAND_LOOKAT, id, time);
+    c.P[0] = P;
+    return c;
+}
+
+inline cameraCommand TranslateCommand(unsigned int id, glm::vec3 P, float time){
+    cameraCommand c = CameraCommand(COMMAND_TRANSLATE, id, time);
+    c.P[0] = P;
+    return c;
+}
+
+inline cameraCommand RotateRPCommand(unsigned int id, glm::vec3 P, float angle, float time){
+    cameraCommand c = CameraCommand(COMMAND_RP, id, time);
+    c.P[0] = P;
+    c.Value[0] = angle;
+    return c;
+}
+
+inline cameraCommand RotateRACommand(unsigned int id, glm::vec3 axis, float angle, float time){
+    cameraCommand c = CameraCommand(COMMAND_RA, id, time);
+    c.P[0] = axis;
+    c.Value[0] = angle;
+    return c;
+}
+
+inline cameraCommand CurveCommand(CameraCommandType type, unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+    cameraCommand c = CameraCommand(type, id, time);
+    c.P[0] = P0;
+    c.P[1] = P1;
+    c.P[2] = P2;
+    c.P[3] = P3;
+    return c;
+}
+
+inline cameraCommand BSplineCommand(unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+    return CurveCommand(COMMAND_BSPLINE, id, P0, P1, P2, P3, time);
+}
+
+inline cameraCommand BezierCommand(unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+    return CurveCommand(COMMAND_BEZIER, id, P0, P1, P2, P3, time);
+}
+
+// The path must outlive the command and the transformation
+inline cameraCommand PathCommand(unsigned int id, const CameraPath *path, float time, bool orient = false, float lookAhead = 0.0f){
+    cameraCommand c = CameraCommand(COMMAND_PATH, id, time);
+    c.Path = path;
+    c.Value[0] = orient ? 1.0f : 0.0f;
+    c.Value[1] = lookAhead;
+    return c;
+}
+
+inline cameraCommand SplineCommand(unsigned int id, const SplinePath *path){
+    cameraCommand c = CameraCommand(COMMAND_SPLINE, id, 0);
+    c.Spline = path;
+    return c;
+}
+
+inline cameraCommand StartNoiseCommand(unsigned int id, float amplitude, float rotationAmplitude, float frequency = 1.0f, unsigned int octaves = 3, float phase = 0.0f){
+    cameraCommand c = CameraCommand(COMMAND_NOISE_START, id, 0);
+    c.Value[0] = amplitude;
+    c.Value[1] = rotationAmplitude;
+    c.Value[2] = frequency;
+    c.Value[3] = phase;
+    c.Octaves = octaves;
+    return c;
+}
+
+inline cameraCommand StopNoiseCommand(unsigned int id){
+    return CameraCommand(COMMAND_NOISE_STOP, id, 0);
+}
+
+// Calls the method a command stands for. The camera id is ignored for a single Camera
+inline void ApplyCameraCommand(const cameraCommand &c, Camera &camera)
+{
+    switch(c.Type){
+    case COMMAND_LOOKAT:      camera.LookAt(c.P[0], c.Time); break;
+    case COMMAND_TRANSLATE:   camera.Translate(c.P[0], c.Time); break;
+    case COMMAND_RP:          camera.rotateRP(c.P[0], c.Value[0], c.Time); break;
+    case COMMAND_RA:          camera.rotateRA(c.P[0], c.Value[0], c.Time); break;
+    case COMMAND_BSPLINE:     camera.bSplinePath(c.P[0], c.P[1], c.P[2], c.P[3], c.Time); break;
+    case COMMAND_BEZIER:      camera.bezierPath(c.P[0], c.P[1], c.P[2], c.P[3], c.Time); break;
+    case COMMAND_PATH:        camera.followPath(c.Path, c.Time, c.Value[0] != 0, c.Value[1]); break;
+    case COMMAND_SPLINE:      camera.followSpline(c.Spline); break;
+    case COMMAND_NOISE_START: camera.StartNoise(c.Value[0], c.Value[1], c.Value[2], c.Octaves, c.Value[3]); break;
+    case COMMAND_NOISE_STOP:  camera.StopNoise(); break;
+    }
+}
+
+// Commands for unknown cameras are dropped
+inline void ApplyCameraCommand(const cameraCommand &c, std::vector<Camera> &cameras)
+{
+    if(c.Camera < cameras.size())
+        ApplyCameraCommand(c, cameras[c.Camera]);
+}
+
+// Here the id is a handle, so commands for cameras destroyed since are dropped too
+inline void ApplyCameraCommand(const cameraCommand &c, SlotMap<Camera> &cameras)
+{
+    if(Camera *camera = cameras.Get(c.Camera))
+        ApplyCameraCommand(c, *camera);
+}
+
+inline void ApplyCameraCommand(const cameraCommand &c, CameraSystem &system)
+{
+    unsigned int id = c.Camera;
+    if(id >= system.Size())
+        return;
+    switch(c.Type){
+    case COMMAND_LOOKAT:      system.LookAt(id, c.P[0], c.Time); break;
+    case COMMAND_TRANSLATE:   system.Translate(id, c.P[0], c.Time); break;
+    case COMMAND_RP:          system.rotateRP(id, c.P[0], c.Value[0], c.Time); break;
+    case COMMAND_RA:          system.rotateRA(id, c.P[0], c.Value[0], c.Time); break;
+    case COMMAND_BSPLINE:     system.bSplinePath(id, c.P[0], c.P[1], c.P[2], c.P[3], c.Time); break;
+    case COMMAND_BEZIER:      system.bezierPath(id, c.P[0], c.P[1], c.P[2], c.P[3], c.Time); break;
+    case COMMAND_PATH:        system.followPath(id, c.Path, c.Time, c.Value[0] != 0, c.Value[1]); break;
+    case COMMAND_SPLINE:      system.followSpline(id, c.Spline); break;
+    case COMMAND_NOISE_START: system.StartNoise(id, c.Value[0], c.Value[1], c.Value[2], c.Octaves, c.Value[3]); break;
+    case COMMAND_NOISE_STOP:  system.StopNoise(id); break;
+    }
+}
+
+// Bounded multi-producer single-consumer channel of camera commands. Any thread can submit; the render
+// thread drains it once per frame and applies the commands to its cameras, so the queues of the
+// cameras are only ever touched by that one thread.
+// Each slot carries a sequence number that says whose turn it is: producers claim a slot with one
+// compare-and-swap on the enqueue index and publish it by bumping its sequence, so submitting never
+// takes a lock and never allocates, and a full channel turns the command down instead of waiting.
+class CameraCommandChannel
+{
+public:
+    // capacity is rounded up to a power of two
+    CameraCommandChannel(unsigned int capacity = 4096) : enqueuePos(0), dequeuePos(0)
+    {
+        size_t size = 2;
+        while(size < capacity)
+            size *= 2;
+        slots = new slot[size];
+        for(size_t i = 0; i < size; i++)
+            slots[i].Sequence.store(i, std::memory_order_relaxed);
+        mask = size - 1;
+    }
+
+    ~CameraCommandChannel() {
+        delete[] slots;
+    }
+
+    size_t Capacity() const {
+        return mask + 1;
+    }
+
+    // Producer side, from any thread. Each returns false when the channel is full
+    bool LookAt(unsigned int id, glm::vec3 P, float time){
+        return Submit(LookAtCommand(id, P, time));
+    }
+
+    bool Translate(unsigned int id, glm::vec3 P, float time){
+        return Submit(TranslateCommand(id, P, time));
+    }
+
+    bool rotateRP(unsigned int id, glm::vec3 P, float angle, float time){
+        return Submit(RotateRPCommand(id, P, angle, time));
+    }
+
+    bool rotateRA(unsigned int id, glm::vec3 axis, float angle, float time){
+        return Submit(RotateRACommand(id, axis, angle, time));
+    }
+
+    bool bSplinePath(unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+        return Submit(BSplineCommand(id, P0, P1, P2, P3, time));
+    }
+
+    bool bezierPath(unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+        return Submit(BezierCommand(id, P0, P1, P2, P3, time));
+    }
+
+    bool followPath(unsigned int id, const CameraPath *path, float time, bool orient = false, float lookAhead = 0.0f){
+        return Submit(PathCommand(id, path, time, orient, lookAhead));
+    }
+
+    bool followSpline(unsigned int id, const SplinePath *path){
+        return Submit(SplineCommand(id, path));
+    }
+
+    bool StartNoise(unsigned int id, float amplitude, float rotationAmplitude, float frequency = 1.0f, unsigned int octaves = 3, float phase = 0.0f){
+        return Submit(StartNoiseCommand(id, amplitude, rotationAmplitude, frequency, octaves, phase));
+    }
+
+    bool StopNoise(unsigned int id){
+        return Submit(StopNoiseCommand(id));
+    }
+
+    bool Submit(const cameraCommand &c)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        slot *s;
+        for(;;){
+            s = &slots[pos & mask];
+            size_t seq = s->Sequence.load(std::memory_order_acquire);
+            ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+            if(diff == 0){
+                // the slot is free for this position, claim it (pos is reloaded if another producer won)
+                if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if(diff < 0)
+                return false;       // the consumer hasn't taken this slot's last command yet
+            else
+                pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+        s->Command = c;
+        s->Sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, from the render thread only. Takes the next command, false if there is none
+    // (or if the producer that claimed the next slot hasn't finished writing it)
+    bool Pop(cameraCommand &c)
+    {
+        slot &s = slots[dequeuePos & mask];
+        if(s.Sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            return false;
+        c = s.Command;
+        s.Sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+    // Applies up to one channel's worth of commands, so producers that keep submitting can't hold
+    // up the frame, and returns how many were applied. Commands for unknown cameras are dropped
+    template <typename Cameras>
+    unsigned int Drain(Cameras &cameras)
+    {
+        cameraCommand c;
+        unsigned int n = 0;
+        while(n <= mask && Pop(c)){
+            ApplyCameraCommand(c, cameras);
+            n++;
+        }
+        return n;
+    }
+
+private:
+    struct slot {
+        std::atomic<size_t> Sequence;
+        cameraCommand Command;
+    };
+
+    slot *slots;
+    size_t mask;
+
+    std::atomic<size_t> enqueuePos;
+    // producers fight over the enqueue index, keep it off the consumer's cache line
+    char padding[64];
+    size_t dequeuePos;
+
+    CameraCommandChannel(const CameraCommandChannel &);
+    CameraCommandChannel &operator=(const CameraCommandChannel &);
+};
+#endif
@@ -0,0 +1,132 @@
+#ifndef CAMERA_GROUP_H
+#define CAMERA_GROUP_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_system.h>
+#include <learnopengl/slot_map.h>
+
+#include <vector>
+
+// Cameras moving in formation, e.g. a rig of cameras around one rail. The trajectory is given once, to
+// the group's Rig camera, and evaluated once per frame; every member is then placed at a fixed offset and
+// rotation from the rig in one pass over flat arrays. N cameras following the same bezierPath cost one
+// curve evaluation instead of N. Members are ids of the cameras they drive: indices into a
+// vector<Camera> or a CameraSystem, or SlotMap handles. Give the members no transformations of their own,
+// or Apply will overwrite them.
+class CameraGroup
+{
+public:
+    // Queue the shared transformations on the rig like on any camera
+    Camera Rig;
+
+    // Per member: the camera it drives, its offset in the rig's frame and its orientation relative to the rig
+    std::vector<unsigned int> Members;
+    Vec3Array Offsets;
+    std::vector<glm::quat> Rotations;
+
+    // World poses of the members as of the last Update
+    Vec3Array Positions;
+    std::vector<glm::quat> Orientations;
+
+    // Returns the member's index
+    unsigned int Add(unsigned int camera, glm::vec3 offset, glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f))
+    {
+        Members.push_back(camera);
+        Offsets.push_back(offset);
+        Rotations.push_back(rotation);
+        Positions.push_back(Rig.Position + Rig.Orientation * offset);
+        Orientations.push_back(Rig.Orientation * rotation);
+        return Size() - 1;
+    }
+
+    // Moves the last member into the removed one's place. Returns false if the camera isn't a member
+    bool Remove(unsigned int camera)
+    {
+        unsigned int i = 0;
+        while(i < Size() && Members[i] != camera)
+            i++;
+        if(i == Size())
+            return false;
+
+        unsigned int last = Size() - 1;
+        Members[i] = Members[last];
+        Offsets.set(i, Offsets.get(last));
+        Rotations[i] = Rotations[last];
+        Positions.set(i, Positions.get(last));
+        Orientations[i] = Orientations[last];
+
+        Members.pop_back();
+        Rotations.pop_back();
+        Orientations.pop_back();
+        popBack(Offsets);
+        popBack(Positions);
+        return true;
+    }
+
+    unsigned int Size() const {
+        return (unsigned int)Members.size();
+    }
+
+    // Evaluates the rig at time and places every member around it
+    void Update(float time)
+    {
+        Rig.evaluateAt(time);
+
+        glm::vec3 p = Rig.Position;
+        glm::quat q = Rig.Orientation;
+        glm::mat3 r = glm::mat3_cast(q);
+        unsigned int count = Size();
+
+        // position = p + r * offset, one component array at a time
+        const float *ox = count ? &Offsets.x[0] : NULL, *oy = count ? &Offsets.y[0] : NULL, *oz = count ? &Offsets.z[0] : NULL;
+        float *px = count ? &Positions.x[0] : NULL, *py = count ? &Positions.y[0] : NULL, *pz = count ? &Positions.z[0] : NULL;
+        for(unsigned int i = 0; i < count; i++){
+            px[i] = p.x + r[0][0] * ox[i] + r[1][0] * oy[i] + r[2][0] * oz[i];
+            py[i] = p.y + r[0][1] * ox[i] + r[1][1] * oy[i] + r[2][1] * oz[i];
+            pz[i] = p.z + r[0][2] * ox[i] + r[1][2] * oy[i] + r[2][2] * oz[i];
+        }
+        for(unsigned int i = 0; i < count; i++)
+            Orientations[i] = q * Rotations[i];
+    }
+
+    // Writes the member poses into their cameras. Members whose camera is gone are skipped
+    void Apply(std::vector<Camera> &cameras) const
+    {
+        for(unsigned int i = 0; i < Size(); i++)
+            if(Members[i] < cameras.size())
+                cameras[Members[i]].setPose(Positions.get(i), Orientations[i]);
+    }
+
+    void Apply(SlotMap<Camera> &cameras) const
+    {
+        for(unsigned int i = 0; i < Size(); i++)
+            if(Camera *camera = cameras.Get(Members[i]))
+                camera->setPose(Positions.get(i), Orientations[i]);
+    }
+
+    void Apply(CameraSystem &system) const
+    {
+        for(unsigned int i = 0; i < Size(); i++)
+            if(Members[i] < system.Size())
+                system.SetPose(Members[i], Positions.get(i), Orientations[i]);
+    }
+
+    // Update then Apply
+    template <typename Cameras>
+    void Update(float time, Cameras &cameras)
+    {
+        Update(time);
+        Apply(cameras);
+    }
+
+private:
+    static void popBack(Vec3Array &a){
+        a.x.pop_back();
+        a.y.pop_back();
+        a.z.pop_back();
+    }
+};
+#endif
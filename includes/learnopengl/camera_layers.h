@@ -0,0 +1,102 @@
+#ifndef CAMERA_LAYERS_H
+#define CAMERA_LAYERS_H
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Every kind of transformation is a layer. Each frame the active layers run from the lowest priority
+// to the highest; each one takes the pose left by the layers below it, works out its own, and the two
+// are blended by the layer's weight (1 replaces the pose, 0 leaves it alone).
+// The default priorities are the order below.
+enum CameraLayer {
+    LAYER_BSPLINE,
+    LAYER_BEZIER,
+    LAYER_PATH,
+    LAYER_SPLINE,
+    LAYER_TRANSLATION,
+    LAYER_RP,
+    LAYER_RA,
+    LAYER_LOOKAT,
+    LAYER_NOISE,            // only scales the shake, it is always applied last, on the view
+    CAMERA_LAYERS
+};
+
+struct cameraLayer {
+    float Weight;
+    int Priority;
+};
+
+// Index of the lowest set bit of a non-zero mask
+inline unsigned int LowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+// Weights and priorities of a camera's layers, and which ones are active. The active mask has one bit
+// per layer in priority order, so the active layers are visited lowest priority first by taking the
+// lowest set bit until the mask is empty, and idle layers cost nothing at all.
+struct cameraLayers {
+    cameraLayer Layers[CAMERA_LAYERS];
+    unsigned int Active;
+    unsigned char Order[CAMERA_LAYERS];     // layer of each bit
+    unsigned char Bit[CAMERA_LAYERS];       // bit of each layer
+
+    cameraLayers() : Active(0)
+    {
+        for(unsigned int i = 0; i < CAMERA_LAYERS; i++){
+            Layers[i].Weight = 1.0f;
+            Layers[i].Priority = i;
+            Order[i] = Bit[i] = i;
+        }
+    }
+
+    void Activate(CameraLayer layer) {
+        Active |= 1u << Bit[layer];
+    }
+
+    void Deactivate(CameraLayer layer) {
+        Active &= ~(1u << Bit[layer]);
+    }
+
+    bool IsActive(CameraLayer layer) const {
+        return (Active >> Bit[layer]) & 1u;
+    }
+
+    void SetWeight(CameraLayer layer, float weight) {
+        Layers[layer].Weight = weight;
+    }
+
+    // Layers with the same priority keep the default order between them
+    void SetPriority(CameraLayer layer, int priority)
+    {
+        bool active[CAMERA_LAYERS];
+        for(unsigned int i = 0; i < CAMERA_LAYERS; i++)
+            active[i] = IsActive((CameraLayer)i);
+
+        Layers[layer].Priority = priority;
+        // insertion sort by priority, stable so ties stay in layer order
+        for(unsigned int i = 0; i < CAMERA_LAYERS; i++)
+            Order[i] = i;
+        for(unsigned int i = 1; i < CAMERA_LAYERS; i++)
+            for(unsigned int j = i; j > 0 && Layers[Order[j]].Priority < Layers[Order[j - 1]].Priority; j--){
+                unsigned char t = Order[j];
+                Order[j] = Order[j - 1];
+                Order[j - 1] = t;
+            }
+
+        Active = 0;
+        for(unsigned int i = 0; i < CAMERA_LAYERS; i++){
+            Bit[Order[i]] = i;
+            if(active[Order[i]])
+                Active |= 1u << i;
+        }
+    }
+};
+#endif
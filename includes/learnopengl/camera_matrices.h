@@ -0,0 +1,71 @@
+#ifndef CAMERA_MATRICES_H
+#define CAMERA_MATRICES_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/camera_orientation.h>
+
+// The view, projection and view-projection matrices of one camera. Each matrix remembers the values
+// it was built from and is only rebuilt when one of them changes, so an idle camera costs a few compares.
+struct cameraMatrices {
+    glm::mat4 View;
+    glm::mat4 Projection;
+    glm::mat4 ViewProjection;
+
+    cameraMatrices() : viewValid(false), projectionValid(false), viewProjectionValid(false) {}
+
+    const glm::mat4 &GetView(glm::vec3 position, glm::quat orientation)
+    {
+        if(!viewValid || position != viewPosition || orientation != viewOrientation){
+            View = ViewFromOrientation(orientation, position);
+            viewPosition = position;
+            viewOrientation = orientation;
+            viewValid = true;
+            viewProjectionValid = false;
+        }
+        return View;
+    }
+
+    const glm::mat4 &GetProjection(float zoom, float aspect, float near, float far)
+    {
+        if(!projectionValid || zoom != projectionZoom || aspect != projectionAspect || near != projectionNear || far != projectionFar){
+            Projection = glm::perspective(glm::radians(zoom), aspect, near, far);
+            projectionZoom = zoom;
+            projectionAspect = aspect;
+            projectionNear = near;
+            projectionFar = far;
+            projectionValid = true;
+            viewProjectionValid = false;
+        }
+        return Projection;
+    }
+
+    const glm::mat4 &GetViewProjection(glm::vec3 position, glm::quat orientation, float zoom, float aspect, float near, float far)
+    {
+        GetView(position, orientation);
+        GetProjection(zoom, aspect, near, far);
+        if(!viewProjectionValid){
+            ViewProjection = Projection * View;
+            viewProjectionValid = true;
+        }
+        return ViewProjection;
+    }
+
+    // Forces every matrix to be rebuilt on its next use
+    void Invalidate()
+    {
+        viewValid = projectionValid = viewProjectionValid = false;
+    }
+
+private:
+    glm::vec3 viewPosition;
+    glm::quat viewOrientation;
+    float projectionZoom, projectionAspect, projectionNear, projectionFar;
+
+    bool viewValid;
+    bool projectionValid;
+    bool viewProjectionValid;
+};
+#endif
@@ -0,0 +1,119 @@
+#ifndef CAMERA_NOISE_H
+#define CAMERA_NOISE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/noise.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+
+// Samples per channel in the noise table and the noise period they cover, in lattice units
+const unsigned int NOISE_SAMPLES = 1024;
+const float NOISE_PERIOD = 64.0f;
+// Three position and three rotation (pitch, yaw, roll) channels
+const unsigned int NOISE_CHANNELS = 6;
+
+// Periodic Perlin noise baked into one table per channel. Built once and shared by every camera,
+// so a shaking camera costs a few table lookups per frame instead of several glm::perlin calls.
+class NoiseTable
+{
+public:
+    // Interleaved by sample, so one lookup of all the channels reads one cache line
+    float Samples[NOISE_SAMPLES][NOISE_CHANNELS];
+
+    NoiseTable()
+    {
+        for(unsigned int c = 0; c < NOISE_CHANNELS; c++)
+            for(unsigned int i = 0; i < NOISE_SAMPLES; i++){
+                glm::vec2 p = glm::vec2(i * NOISE_PERIOD / NOISE_SAMPLES, c * 7.31f + 0.5f);
+                Samples[i][c] = glm::perlin(p, glm::vec2(NOISE_PERIOD, 256.0f));
+            }
+    }
+
+    static const NoiseTable &Shared()
+    {
+        static NoiseTable table;
+        return table;
+    }
+
+    // Noise of one channel at x lattice units, wrapping around the period
+    float Sample(unsigned int channel, float x) const
+    {
+        unsigned int i;
+        float t;
+        locate(x, i, t);
+        float a = Samples[i][channel], b = Samples[(i + 1) & (NOISE_SAMPLES - 1)][channel];
+        return a + t * (b - a);
+    }
+
+    // Sum of octaves, each one at twice the frequency and half the weight of the previous, kept in [-1, 1]
+    float Fractal(unsigned int channel, float x, unsigned int octaves) const
+    {
+        float sum = 0, weight = 1, total = 0;
+        for(unsigned int o = 0; o < octaves; o++){
+            sum += weight * Sample(channel, x);
+            total += weight;
+            x *= 2;
+            weight *= 0.5f;
+        }
+        return total > 0 ? sum / total : 0;
+    }
+
+    // Fractal noise of every channel at once; the table position is worked out once per octave
+    void FractalAll(float x, unsigned int octaves, float out[NOISE_CHANNELS]) const
+    {
+        for(unsigned int c = 0; c < NOISE_CHANNELS; c++)
+            out[c] = 0;
+
+        float weight = 1, total = 0;
+        for(unsigned int o = 0; o < octaves; o++){
+            unsigned int i;
+            float t;
+            locate(x, i, t);
+            unsigned int j = (i + 1) & (NOISE_SAMPLES - 1);
+            for(unsigned int c = 0; c < NOISE_CHANNELS; c++)
+                out[c] += weight * (Samples[i][c] + t * (Samples[j][c] - Samples[i][c]));
+            total += weight;
+            x *= 2;
+            weight *= 0.5f;
+        }
+
+        if(total > 0)
+            for(unsigned int c = 0; c < NOISE_CHANNELS; c++)
+                out[c] /= total;
+    }
+
+private:
+    // Table index and blend factor for x lattice units
+    static void locate(float x, unsigned int &i, float &t)
+    {
+        float f = x * (NOISE_SAMPLES / NOISE_PERIOD);
+        f -= std::floor(f * (1.0f / NOISE_SAMPLES)) * NOISE_SAMPLES;
+        i = (unsigned int)f;
+        t = f - i;
+        i &= NOISE_SAMPLES - 1;
+    }
+};
+
+// Camera shake and handheld drift parameters
+struct cameraNoise {
+    float Amplitude;            // largest position offset, in world units
+    float RotationAmplitude;    // largest rotation around each camera axis, in radians
+    float Frequency;            // noise lattice units per second
+    unsigned int Octaves;
+    float Phase;                // keeps cameras from shaking in sync
+
+    // Offsets at a time, both in the camera's own frame
+    void Evaluate(float time, glm::vec3 &offset, glm::quat &rotation) const
+    {
+        float n[NOISE_CHANNELS];
+        NoiseTable::Shared().FractalAll(time * Frequency + Phase, Octaves, n);
+
+        offset = Amplitude * glm::vec3(n[0], n[1], n[2]);
+
+        // small angles, so half the angles make a good enough quaternion once normalized
+        glm::vec3 angles = 0.5f * RotationAmplitude * glm::vec3(n[3], n[4], n[5]);
+        rotation = glm::normalize(glm::quat(1.0f, angles.x, angles.y, angles.z));
+    }
+};
+#endif
@@ -0,0 +1,101 @@
+#ifndef CAMERA_ORIENTATION_H
+#define CAMERA_ORIENTATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+
+// Camera orientations are unit quaternions that turn the camera's local axes
+// (Right = +X, Up = +Y, Front = -Z) into world space.
+
+// Orientation looking along front with up as the reference up direction. When front is parallel to up,
+// fallbackUp is used instead, so looking straight up or down never produces a degenerate frame.
+inline glm::quat OrientationFromVectors(glm::vec3 front, glm::vec3 up, glm::vec3 fallbackUp = glm::vec3(0.0f, 0.0f, -1.0f))
+{
+    glm::vec3 f = glm::normalize(front);
+    glm::vec3 r = glm::cross(f, up);
+    if(glm::dot(r, r) < 1e-10f)
+        r = glm::cross(f, fallbackUp);
+    if(glm::dot(r, r) < 1e-10f)
+        r = glm::cross(f, glm::vec3(1.0f, 0.0f, 0.0f));
+    r = glm::normalize(r);
+    glm::vec3 u = glm::cross(r, f);
+
+    return glm::normalize(glm::quat_cast(glm::mat3(r, u, -f)));
+}
+
+// Same matrix as glm::lookAt(position, position + front, up), built straight from the orientation
+inline glm::mat4 ViewFromOrientation(glm::quat orientation, glm::vec3 position)
+{
+    glm::mat3 rotation = glm::mat3_cast(glm::conjugate(orientation));
+    glm::mat4 view = glm::mat4(rotation);
+    view[3] = glm::vec4(-(rotation * position), 1.0f);
+    return view;
+}
+
+// Slerp between two orientations with the angle worked out once, so every frame costs two sin()
+// and no acos(). Always takes the shortest way and falls back to nlerp for tiny angles.
+struct orientationSlerp {
+    glm::quat From;
+    glm::quat To;
+    float Angle;
+    float InvSin;
+
+    void Set(glm::quat from, glm::quat to){
+        From = from;
+        To = to;
+        float cosTheta = glm::dot(from, to);
+        if(cosTheta < 0){
+            To = -to;
+            cosTheta = -cosTheta;
+        }
+        Angle = cosTheta < 0.9995f ? std::acos(cosTheta) : 0.0f;
+        InvSin = Angle > 0 ? 1.0f / std::sin(Angle) : 0.0f;
+    }
+
+    glm::quat At(float t) const {
+        if(Angle == 0)
+            return glm::normalize(From * (1 - t) + To * t);
+        return (From * std::sin((1 - t) * Angle) + To * std::sin(t * Angle)) * InvSin;
+    }
+};
+
+// Spin around a fixed world axis, advanced by small steps. The step rotor is only rebuilt when
+// the step angle changes, so a fixed time step spins the camera with one quaternion product per frame.
+struct axisRotor {
+    glm::vec3 Axis;
+    glm::quat Start;
+    glm::quat Current;
+    glm::quat Step;
+    float StepAngle;
+    float Applied;
+
+    void Set(glm::quat start, glm::vec3 axis){
+        Axis = glm::dot(axis, axis) > 0 ? glm::normalize(axis) : glm::vec3(0.0f, 1.0f, 0.0f);
+        Start = Current = start;
+        Step = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        StepAngle = 0;
+        Applied = 0;
+    }
+
+    // Orientation after a total rotation of angle since Set
+    glm::quat Advance(float angle){
+        float delta = angle - Applied;
+        if(std::fabs(delta - StepAngle) > 1e-6f){
+            Step = glm::angleAxis(delta, Axis);
+            StepAngle = delta;
+        }
+        Current = glm::normalize(Step * Current);
+        Applied = angle;
+        return Current;
+    }
+
+    // Exact orientation for a total angle, used to land on the final orientation without drift
+    glm::quat Exact(float angle){
+        Current = glm::angleAxis(angle, Axis) * Start;
+        Applied = angle;
+        return Current;
+    }
+};
+#endif
@@ -0,0 +1,194 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/spline.hpp>
+
+#include <learnopengl/bezier_curve.h>
+#include <learnopengl/camera_orientation.h>
+
+#include <algorithm>
+#include <vector>
+
+// Default number of entries in the arc-length table of a path
+const unsigned int PATH_SAMPLES = 256;
+
+// A curve baked into a table of points evenly spaced by arc length.
+// Build it once, then Sample() returns the point at a fraction of the total length in O(1),
+// so a camera that follows it moves at constant speed and never re-evaluates the curve.
+// Cameras only keep a pointer to the path, so one path can be shared by many cameras.
+class CameraPath
+{
+public:
+    // Points evenly spaced by arc length, first and last are the curve end points
+    std::vector<glm::vec3> Points;
+    // Camera orientation at each point, looking along the path (see BuildFrames)
+    std::vector<glm::quat> Frames;
+    float Length;
+
+    CameraPath() : Length(0) {}
+
+    // Cubic Bezier with the same control points as Camera::bezierPath. For other degrees, rational
+    // curves and NURBS see bezier_curve.h, and bake them with FromCurve
+    static CameraPath Bezier(glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, unsigned int samples = PATH_SAMPLES)
+    {
+        BezierCurve<3> curve = {{ P0, P1, P2, P3 }};
+        CameraPath path;
+        path.build(curve, samples);
+        return path;
+    }
+
+    // Catmull-Rom through four points, with the same three segments as Camera::bSplinePath
+    static CameraPath CatmullRom(glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, unsigned int samples = PATH_SAMPLES)
+    {
+        CatmullRomCurve curve = { P0, P1, P2, P3 };
+        CameraPath path;
+        path.build(curve, samples);
+        return path;
+    }
+
+    // Any curve given as a function object mapping t in [0, 1] to a point
+    template <typename Curve>
+    static CameraPath FromCurve(Curve curve, unsigned int samples = PATH_SAMPLES)
+    {
+        CameraPath path;
+        path.build(curve, samples);
+        return path;
+    }
+
+    // Point at a fraction of the path length, clamped to [0, 1]
+    glm::vec3 Sample(float fraction) const
+    {
+        if(Points.empty())
+            return glm::vec3(0);
+        if(Points.size() < 2)
+            return Points[0];
+
+        float f = std::min(std::max(fraction, 0.0f), 1.0f) * (Points.size() - 1);
+        unsigned int i = std::min((unsigned int)f, (unsigned int)Points.size() - 2);
+        return glm::mix(Points[i], Points[i + 1], f - i);
+    }
+
+    // Point at a distance from the start of the path
+    glm::vec3 SampleDistance(float distance) const
+    {
+        return Sample(Length > 0 ? distance / Length : 0);
+    }
+
+    // Orientation looking along the path at a fraction of its length, clamped to [0, 1]. Neighbouring
+    // frames are only a small angle apart, so they are blended with a normalized lerp
+    glm::quat SampleOrientation(float fraction) const
+    {
+        if(Frames.empty())
+            return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        if(Frames.size() < 2)
+            return Frames[0];
+
+        float f = std::min(std::max(fraction, 0.0f), 1.0f) * (Frames.size() - 1);
+        unsigned int i = std::min((unsigned int)f, (unsigned int)Frames.size() - 2);
+        float t = f - i;
+        return glm::normalize(Frames[i] * (1 - t) + Frames[i + 1] * t);
+    }
+
+    // Rotation-minimizing frames along the points, by the double reflection method: the first frame has
+    // up as close as possible to the given up, and every next one is the previous one carried along the
+    // path with as little twist as possible, so the camera doesn't roll or flip through loops and over the top
+    // of climbs the way a fixed world up would make it. Built with the path; call again for another start up
+    void BuildFrames(glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f))
+    {
+        unsigned int n = (unsigned int)Points.size();
+        Frames.resize(n);
+        if(n == 0)
+            return;
+
+        glm::vec3 front = tangent(0, glm::vec3(0.0f, 0.0f, -1.0f));
+        Frames[0] = OrientationFromVectors(front, up);
+        glm::vec3 right = Frames[0] * glm::vec3(1.0f, 0.0f, 0.0f);
+
+        for(unsigned int i = 0; i + 1 < n; i++){
+            glm::vec3 nextFront = tangent(i + 1, front);
+
+            // reflect the frame across the plane between the two points, then across the one between the reflected and the next tangent
+            glm::vec3 v1 = Points[i + 1] - Points[i];
+            float c1 = glm::dot(v1, v1);
+            glm::vec3 r = right, t = front;
+            if(c1 > 0){
+                r -= (2 / c1) * glm::dot(v1, r) * v1;
+                t -= (2 / c1) * glm::dot(v1, t) * v1;
+            }
+            glm::vec3 v2 = nextFront - t;
+            float c2 = glm::dot(v2, v2);
+            if(c2 > 0)
+                r -= (2 / c2) * glm::dot(v2, r) * v2;
+
+            // keep the frame orthonormal against rounding
+            r -= glm::dot(r, nextFront) * nextFront;
+            if(glm::dot(r, r) < 1e-12f)
+                r = right;
+            right = glm::normalize(r);
+            front = nextFront;
+
+            glm::quat q = glm::normalize(glm::quat_cast(glm::mat3(right, glm::cross(right, front), -front)));
+            // same hemisphere as the previous frame, so the blend in SampleOrientation takes the short way
+            Frames[i + 1] = glm::dot(q, Frames[i]) < 0 ? -q : q;
+        }
+    }
+
+private:
+    struct CatmullRomCurve {
+        glm::vec3 p0, p1, p2, p3;
+
+        glm::vec3 operator()(float t) const {
+            float f = t * 3;
+            if(f <= 1)
+                return glm::catmullRom(p0, p0, p1, p2, f);
+            if(f <= 2)
+                return glm::catmullRom(p0, p1, p2, p3, f - 1);
+            return glm::catmullRom(p1, p2, p3, p3, f - 2);
+        }
+    };
+
+    // Measures the curve with a dense polyline, then inverts the cumulative length
+    // to place samples + 1 points at equal distances along it.
+    template <typename Curve>
+    void build(const Curve &curve, unsigned int samples)
+    {
+        samples = std::max(samples, 1u);
+        unsigned int dense = samples * 8;
+
+        std::vector<glm::vec3> polyline(dense + 1);
+        std::vector<float> distance(dense + 1);
+        polyline[0] = curve(0.0f);
+        distance[0] = 0;
+        for(unsigned int i = 1; i <= dense; i++){
+            polyline[i] = curve((float)i / dense);
+            distance[i] = distance[i - 1] + glm::length(polyline[i] - polyline[i - 1]);
+        }
+        Length = distance[dense];
+
+        Points.resize(samples + 1);
+        Points[0] = polyline[0];
+        Points[samples] = polyline[dense];
+        unsigned int j = 0;
+        for(unsigned int i = 1; i < samples; i++){
+            float target = Length * i / samples;
+            while(j < dense && distance[j + 1] < target)
+                j++;
+            float span = distance[j + 1] - distance[j];
+            float f = span > 0 ? (target - distance[j]) / span : 0;
+            Points[i] = glm::mix(polyline[j], polyline[j + 1], f);
+        }
+        BuildFrames();
+    }
+
+    // Direction of the path at a point, from its neighbours. Paths of zero length keep the fallback
+    glm::vec3 tangent(unsigned int i, glm::vec3 fallback) const
+    {
+        unsigned int n = (unsigned int)Points.size();
+        glm::vec3 d = Points[std::min(i + 1, n - 1)] - Points[i > 0 ? i - 1 : 0];
+        float length = glm::length(d);
+        return length > 0 ? d / length : fallback;
+    }
+};
+#endif
@@ -0,0 +1,57 @@
+#ifndef CAMERA_POLICY_H
+#define CAMERA_POLICY_H
+
+#include <learnopengl/camera_pool.h>
+
+#include <cstddef>
+
+// What happens to the transformations already queued on a layer when a new one arrives
+enum QueuePolicy {
+    QUEUE_APPEND,       // waits for the ones before it (the default)
+    QUEUE_REPLACE,      // drops the waiting ones; the running one finishes first
+    QUEUE_MERGE,        // retargets the last waiting one instead (lookAt and translation), otherwise appends
+    QUEUE_PREEMPT       // cancels the running and the waiting ones, and starts at once from the current pose
+};
+
+struct queuePolicy {
+    QueuePolicy Policy;
+    unsigned int MaxDepth;      // most transformations waiting, the oldest are dropped first (0 = no limit)
+
+    queuePolicy() : Policy(QUEUE_APPEND), MaxDepth(0) {}
+};
+
+// Transformations that can't be merged are appended. lookAt and translation overload this in camera.h
+template <typename T>
+inline bool MergeTransformation(T &, const T &)
+{
+    return false;
+}
+
+// Queues a transformation following a policy. A front entry that has Started is the one running, and
+// only QUEUE_PREEMPT drops it; entries behind it are waiting
+template <typename T>
+void EnqueueTransformation(PoolQueue<T> &queue, const T &value, const queuePolicy &policy)
+{
+    size_t running = !queue.empty() && queue.front().Started ? 1 : 0;
+    switch(policy.Policy){
+    case QUEUE_REPLACE:
+        queue.truncate(running);
+        break;
+    case QUEUE_MERGE:
+        if(queue.size() > running && MergeTransformation(queue.back(), value))
+            return;
+        break;
+    case QUEUE_PREEMPT:
+        queue.clear();
+        running = 0;
+        break;
+    default:
+        break;
+    }
+
+    queue.push(value);
+    if(policy.MaxDepth)
+        while(queue.size() - running > policy.MaxDepth)
+            queue.erase(running);
+}
+#endif
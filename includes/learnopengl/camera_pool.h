@@ -0,0 +1,313 @@
+#ifndef CAMERA_POOL_H
+#define CAMERA_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// Nodes for queued transformations of one type, shared by every camera. Nodes are carved out of chunks
+// that are never given back, and finished transformations go to a free list for the next ones, so
+// queuing only touches the general heap while the pool grows to the most transformations ever queued at once.
+// Every thread keeps a small free list of its own and only takes the pool's lock to move BATCH nodes
+// between it and the shared one, so threads updating cameras side by side rarely wait for each other.
+template <typename T>
+class NodePool
+{
+public:
+    struct Node {
+        T Value;
+        Node *Next;
+    };
+
+    // Nodes per chunk
+    static const unsigned int CHUNK = 256;
+    // Nodes moved between a thread's free list and the shared one at a time; a thread keeps at most twice as many
+    static const unsigned int BATCH = 64;
+
+    // Built on first use and never destroyed, so cameras that outlive static destruction can still give their nodes back
+    static NodePool &Shared()
+    {
+        static NodePool *pool = new NodePool();
+        return *pool;
+    }
+
+    Node *Allocate(const T &value)
+    {
+        localList &local = localFree();
+        Node *n;
+        if(local.Ended)
+            n = takeOne();
+        else {
+            if(!local.Head)
+                take(local);
+            n = local.Head;
+            local.Head = n->Next;
+            local.Count--;
+        }
+
+        new (&n->Value) T(value);
+        n->Next = NULL;
+        return n;
+    }
+
+    // Any thread can release a node, whichever thread allocated it
+    void Release(Node *n)
+    {
+        n->Value.~T();
+        localList &local = localFree();
+        if(local.Ended){
+            giveBackOne(n);
+            return;
+        }
+        n->Next = local.Head;
+        local.Head = n;
+        if(++local.Count >= 2 * BATCH)
+            giveBack(local, BATCH);
+    }
+
+    // Nodes out of the shared free list (in use, or waiting in a thread's own list) and nodes allocated so far
+    size_t Used() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return used;
+    }
+
+    size_t Capacity() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return capacity;
+    }
+
+private:
+    Node *free;
+    size_t used;
+    size_t capacity;
+    std::mutex mutex;
+
+    NodePool() : free(NULL), used(0), capacity(0) {}
+
+    // A thread's own free list. It is never destroyed, so cameras destroyed late in the thread's exit (e.g.
+    // globals) can still use it: once its nodes went back to the shared list, Ended sends them there directly
+    struct localList {
+        Node *Head;
+        unsigned int Count;
+        bool Started;
+        bool Ended;
+    };
+
+    // Gives a thread's nodes back when it ends
+    struct localFlush {
+        ~localFlush() {
+            localList &local = localFree();
+            if(local.Count)
+                Shared().giveBack(local, local.Count);
+            local.Ended = true;
+        }
+    };
+
+    static localList &localFree()
+    {
+        static thread_local localList list;     // zero-initialized
+        if(!list.Started){
+            list.Started = true;
+            static thread_local localFlush flush;
+            (void)flush;
+        }
+        return list;
+    }
+
+    Node *takeOne()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!free)
+            grow();
+        Node *n = free;
+        free = n->Next;
+        ++used;
+        return n;
+    }
+
+    void giveBackOne(Node *n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        n->Next = free;
+        free = n;
+        --used;
+    }
+
+    // Moves BATCH nodes from the shared free list to the thread's, growing the pool if there aren't enough
+    void take(localList &local)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(unsigned int i = 0; i < BATCH; i++){
+            if(!free)
+                grow();
+            Node *n = free;
+            free = n->Next;
+            n->Next = local.Head;
+            local.Head = n;
+        }
+        local.Count += BATCH;
+        used += BATCH;
+    }
+
+    // Moves count nodes from the thread's free list to the shared one
+    void giveBack(localList &local, unsigned int count)
+    {
+        Node *first = local.Head, *last = first;
+        for(unsigned int i = 1; i < count; i++)
+            last = last->Next;
+        local.Head = last->Next;
+        local.Count -= count;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        last->Next = free;
+        free = first;
+        used -= count;
+    }
+
+    void grow()
+    {
+        Node *chunk = static_cast<Node *>(::operator new(sizeof(Node) * CHUNK));
+        for(unsigned int i = 0; i < CHUNK; i++){
+            chunk[i].Next = free;
+            free = &chunk[i];
+        }
+        capacity += CHUNK;
+    }
+};
+
+// FIFO queue with the interface of std::queue, linked through NodePool nodes. An empty queue is three words
+// and owns no memory, so idle cameras cost nothing on the heap, and moving a queue (e.g. when a vector of
+// cameras grows) only moves pointers.
+template <typename T>
+class PoolQueue
+{
+public:
+    typedef typename NodePool<T>::Node Node;
+
+    PoolQueue() : head(NULL), tail(NULL), count(0) {}
+
+    PoolQueue(const PoolQueue &other) : head(NULL), tail(NULL), count(0)
+    {
+        for(const Node *n = other.head; n; n = n->Next)
+            push(n->Value);
+    }
+
+    PoolQueue(PoolQueue &&other) noexcept : head(other.head), tail(other.tail), count(other.count)
+    {
+        other.head = other.tail = NULL;
+        other.count = 0;
+    }
+
+    PoolQueue &operator=(PoolQueue other) noexcept
+    {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(count, other.count);
+        return *this;
+    }
+
+    ~PoolQueue() {
+        clear();
+    }
+
+    void push(const T &value)
+    {
+        Node *n = NodePool<T>::Shared().Allocate(value);
+        if(tail)
+            tail->Next = n;
+        else
+            head = n;
+        tail = n;
+        ++count;
+    }
+
+    T &front() {
+        return head->Value;
+    }
+
+    const T &front() const {
+        return head->Value;
+    }
+
+    T &back() {
+        return tail->Value;
+    }
+
+    const T &back() const {
+        return tail->Value;
+    }
+
+    void pop()
+    {
+        Node *n = head;
+        head = n->Next;
+        if(!head)
+            tail = NULL;
+        --count;
+        NodePool<T>::Shared().Release(n);
+    }
+
+    bool empty() const {
+        return head == NULL;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    void clear()
+    {
+        while(head)
+            pop();
+    }
+
+    // Keeps the first n entries and drops the rest
+    void truncate(size_t n)
+    {
+        if(n == 0){
+            clear();
+            return;
+        }
+        if(n >= count)
+            return;
+
+        Node *last = head;
+        for(size_t i = 1; i < n; i++)
+            last = last->Next;
+        Node *rest = last->Next;
+        last->Next = NULL;
+        tail = last;
+        count = n;
+        while(rest){
+            Node *next = rest->Next;
+            NodePool<T>::Shared().Release(rest);
+            rest = next;
+        }
+    }
+
+    // Drops the entry at index i (< size())
+    void erase(size_t i)
+    {
+        if(i == 0){
+            pop();
+            return;
+        }
+
+        Node *prev = head;
+        for(size_t k = 1; k < i; k++)
+            prev = prev->Next;
+        Node *n = prev->Next;
+        prev->Next = n->Next;
+        if(tail == n)
+            tail = prev;
+        --count;
+        NodePool<T>::Shared().Release(n);
+    }
+
+private:
+    Node *head;
+    Node *tail;
+    size_t count;
+};
+#endif
@@ -0,0 +1,270 @@
+#ifndef CAMERA_RECORDER_H
+#define CAMERA_RECORDER_H
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_trajectory.h>
+#include <learnopengl/mapped_file.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// Recording files are a recordingHeader followed by one cameraRecord per camera per frame, in frame order
+const uint32_t RECORDING_VERSION = 1;
+
+struct recordingHeader {
+    char Magic[4];              // "CREC"
+    uint32_t Version;
+    uint32_t RecordSize;
+    uint32_t Reserved;
+};
+
+// Pose of one camera in one frame
+struct cameraRecord {
+    uint32_t Frame;
+    uint32_t Camera;
+    float Time;
+    float Position[3];
+    float Orientation[4];       // w, x, y, z
+    float Zoom;
+    float Near;
+    float Far;
+};
+
+// Single-producer single-consumer ring of records. The producer and the consumer each own one index
+// and only read the other's, so neither ever waits for the other.
+class RecordRing
+{
+public:
+    // capacity is rounded up to a power of two
+    RecordRing(unsigned int capacity) : head(0), cachedTail(0), tail(0)
+    {
+        size_t size = 1;
+        while(size < capacity)
+            size *= 2;
+        records.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer side. Returns false, without waiting, when the ring is full
+    bool Push(const cameraRecord &record)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h - cachedTail == records.size()){
+            cachedTail = tail.load(std::memory_order_acquire);
+            if(h - cachedTail == records.size())
+                return false;
+        }
+        records[h & mask] = record;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Copies up to count records into out and returns how many there were
+    size_t Pop(cameraRecord *out, size_t count)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t n = std::min(head.load(std::memory_order_acquire) - t, count);
+        for(size_t i = 0; i < n; i++)
+            out[i] = records[(t + i) & mask];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<cameraRecord> records;
+    size_t mask;
+
+    std::atomic<size_t> head;
+    size_t cachedTail;          // producer's last look at tail
+    // keeps the two indices on different cache lines, so the threads don't keep stealing them from each other
+    char padding[64];
+    std::atomic<size_t> tail;
+};
+
+// Records every camera's pose each frame without stalling the render loop: Record() only copies
+// into a ring buffer, and a background thread writes the ring to disk. If the disk falls behind
+// by a whole ring, records are dropped (and counted) rather than making the render loop wait.
+class CameraRecorder
+{
+public:
+    CameraRecorder() : file(NULL), ring(NULL), running(false), dropped(0), ok(true) {}
+
+    ~CameraRecorder() {
+        Stop();
+    }
+
+    // Starts recording to a file. capacity is the number of records the ring holds
+    bool Start(const char *path, unsigned int capacity = 1 << 16)
+    {
+        Stop();
+        file = fopen(path, "wb");
+        if(!file)
+            return false;
+
+        recordingHeader header;
+        memcpy(header.Magic, "CREC", 4);
+        header.Version = RECORDING_VERSION;
+        header.RecordSize = sizeof(cameraRecord);
+        header.Reserved = 0;
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        ring = new RecordRing(capacity);
+        dropped = 0;
+        running.store(true, std::memory_order_release);
+        drainThread = std::thread(&CameraRecorder::drain, this);
+        return true;
+    }
+
+    bool IsRecording() const {
+        return file != NULL;
+    }
+
+    // Called from the render thread once per camera per frame. Never blocks and never allocates
+    void Record(unsigned int frame, unsigned int id, const Camera &camera)
+    {
+        if(!file)
+            return;
+
+        cameraRecord r;
+        r.Frame = frame;
+        r.Camera = id;
+        r.Time = camera.currTime;
+        r.Position[0] = camera.Position.x;
+        r.Position[1] = camera.Position.y;
+        r.Position[2] = camera.Position.z;
+        r.Orientation[0] = camera.Orientation.w;
+        r.Orientation[1] = camera.Orientation.x;
+        r.Orientation[2] = camera.Orientation.y;
+        r.Orientation[3] = camera.Orientation.z;
+        r.Zoom = camera.Zoom;
+        r.Near = camera.Near;
+        r.Far = camera.Far;
+        if(!ring->Push(r))
+            ++dropped;
+    }
+
+    // Waits for everything recorded so far to be written and closes the file. Returns false if a write failed
+    bool Stop()
+    {
+        if(!file)
+            return true;
+
+        running.store(false, std::memory_order_release);
+        drainThread.join();
+        ok = fclose(file) == 0 && ok;
+        file = NULL;
+        delete ring;
+        ring = NULL;
+        return ok;
+    }
+
+    // Records lost because the ring was full
+    unsigned long long Dropped() const {
+        return dropped;
+    }
+
+private:
+    FILE *file;
+    RecordRing *ring;
+    std::thread drainThread;
+    std::atomic<bool> running;
+    unsigned long long dropped;
+    bool ok;
+
+    CameraRecorder(const CameraRecorder &);
+    CameraRecorder &operator=(const CameraRecorder &);
+
+    void drain()
+    {
+        std::vector<cameraRecord> batch(4096);
+        for(;;){
+            // read before popping, so once it is false the ring is known to be empty after the pop
+            bool stopping = !running.load(std::memory_order_acquire);
+            size_t n = ring->Pop(&batch[0], batch.size());
+            if(n > 0)
+                ok = fwrite(&batch[0], sizeof(cameraRecord), n, file) == n && ok;
+            else if(stopping)
+                break;
+            else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+// A recording file mapped into memory, for auditing and replaying what the cameras did
+class CameraRecording
+{
+public:
+    CameraRecording() : records(NULL), count(0) {}
+
+    bool Open(const char *path)
+    {
+        Close();
+        if(!file.Open(path))
+            return false;
+
+        const recordingHeader *header = (const recordingHeader *)file.Data();
+        if(file.Size() < sizeof(recordingHeader) || memcmp(header->Magic, "CREC", 4) != 0
+           || header->Version != RECORDING_VERSION || header->RecordSize != sizeof(cameraRecord)){
+            Close();
+            return false;
+        }
+        records = (const cameraRecord *)(file.Data() + sizeof(recordingHeader));
+        // a recording cut short keeps every complete record
+        count = (file.Size() - sizeof(recordingHeader)) / sizeof(cameraRecord);
+        return true;
+    }
+
+    void Close()
+    {
+        file.Close();
+        records = NULL;
+        count = 0;
+    }
+
+    size_t Size() const {
+        return count;
+    }
+
+    const cameraRecord &operator[](size_t i) const {
+        return records[i];
+    }
+
+    // Index of the first record of a frame or of the first frame after it, by binary search
+    size_t FindFrame(unsigned int frame) const
+    {
+        size_t lo = 0, hi = count;
+        while(lo < hi){
+            size_t mid = (lo + hi) / 2;
+            if(records[mid].Frame < frame)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // Pose of a record, for Camera::setPose
+    static trajectoryPose Pose(const cameraRecord &r)
+    {
+        trajectoryPose p;
+        p.Position = glm::vec3(r.Position[0], r.Position[1], r.Position[2]);
+        p.Orientation = glm::quat(r.Orientation[0], r.Orientation[1], r.Orientation[2], r.Orientation[3]);
+        p.Zoom = r.Zoom;
+        p.Near = r.Near;
+        p.Far = r.Far;
+        return p;
+    }
+
+private:
+    MappedFile file;
+    const cameraRecord *records;
+    size_t count;
+};
+#endif
@@ -0,0 +1,327 @@
+#ifndef CAMERA_SCHEDULER_H
+#define CAMERA_SCHEDULER_H
+
+#include <learnopengl/camera_commands.h>
+#include <learnopengl/camera_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Hierarchical timer wheel: LEVELS wheels of SLOTS lists each, where level L holds the timers due
+// between SLOTS^L and SLOTS^(L+1) ticks from now. Adding a timer, and firing it, are O(1) whatever the
+// number of timers; a slot of level L > 0 is only looked at when it comes up, once every SLOTS^L ticks,
+// and its timers move down a level. Each level keeps a mask of its slots that have timers, so Advance
+// goes straight to the next slot with something in it instead of stepping through empty ticks.
+// Timers further away than the whole wheel wait in the last level and are moved again until they fit.
+// Timers due on the same tick fire in the order they were added.
+template <typename T>
+class TimerWheel
+{
+public:
+    static const unsigned int BITS = 6;
+    static const unsigned int SLOTS = 1 << BITS;
+    static const unsigned int LEVELS = 4;
+
+    struct timer {
+        T Value;
+        uint64_t Due;
+    };
+    typedef typename NodePool<timer>::Node Node;
+
+    TimerWheel() : lateHead(NULL), lateTail(NULL), now(0), count(0)
+    {
+        for(unsigned int l = 0; l < LEVELS; l++){
+            for(unsigned int s = 0; s < SLOTS; s++)
+                heads[l][s] = tails[l][s] = NULL;
+            used[l] = 0;
+        }
+    }
+
+    ~TimerWheel() {
+        Clear();
+    }
+
+    // Next tick to fire
+    uint64_t Now() const {
+        return now;
+    }
+
+    size_t Size() const {
+        return count;
+    }
+
+    // Timers due before Now() wait apart, and fire on the next Advance to their tick or later, even if
+    // it doesn't go past Now()
+    void Add(uint64_t due, const T &value)
+    {
+        timer t;
+        t.Value = value;
+        t.Due = due;
+        place(NodePool<timer>::Shared().Allocate(t));
+        ++count;
+    }
+
+    // Fires every timer due up to tick (included), in order. fire(value, due) returns true to keep the
+    // timer for another round, with value and due changed through the references
+    template <typename Fire>
+    void Advance(uint64_t tick, Fire &fire)
+    {
+        // they're due before anything in the wheel
+        Node *late = lateHead;
+        lateHead = lateTail = NULL;
+        fireList(late, tick, fire);
+
+        while(now <= tick){
+            // the ticks in between have nothing to fire and no slot to move down
+            uint64_t next = nextTick();
+            if(next > tick){
+                now = tick + 1;
+                break;
+            }
+            now = next;
+
+            // moves the timers of the higher levels down as their slot comes up
+            for(unsigned int l = 1; l < LEVELS && (now & ((uint64_t(1) << (BITS * l)) - 1)) == 0; l++)
+                cascade(l, (unsigned int)(now >> (BITS * l)) & (SLOTS - 1));
+
+            unsigned int s = (unsigned int)now & (SLOTS - 1);
+            Node *n = heads[0][s];
+            heads[0][s] = tails[0][s] = NULL;
+            used[0] &= ~(uint64_t(1) << s);
+            fireList(n, now, fire);
+            now++;
+        }
+    }
+
+    void Clear()
+    {
+        for(unsigned int l = 0; l < LEVELS; l++)
+            for(unsigned int s = 0; s < SLOTS; s++){
+                Node *n = heads[l][s];
+                while(n){
+                    Node *next = n->Next;
+                    NodePool<timer>::Shared().Release(n);
+                    n = next;
+                }
+                heads[l][s] = tails[l][s] = NULL;
+            }
+        for(unsigned int l = 0; l < LEVELS; l++)
+            used[l] = 0;
+        while(lateHead){
+            Node *next = lateHead->Next;
+            NodePool<timer>::Shared().Release(lateHead);
+            lateHead = next;
+        }
+        lateTail = NULL;
+        count = 0;
+    }
+
+private:
+    Node *heads[LEVELS][SLOTS];
+    Node *tails[LEVELS][SLOTS];
+    uint64_t used[LEVELS];          // bit s is set while slot s has timers
+    Node *lateHead, *lateTail;      // due before now when added
+    uint64_t now;
+    size_t count;
+
+    TimerWheel(const TimerWheel &);
+    TimerWheel &operator=(const TimerWheel &);
+
+    void place(Node *n)
+    {
+        n->Next = NULL;
+        if(n->Value.Due < now){
+            if(lateTail)
+                lateTail->Next = n;
+            else
+                lateHead = n;
+            lateTail = n;
+            return;
+        }
+
+        uint64_t due = n->Value.Due;
+        uint64_t delta = due - now;
+        unsigned int l = 0;
+        while(l + 1 < LEVELS && delta >= (uint64_t(1) << (BITS * (l + 1))))
+            l++;
+        if(delta >= (uint64_t(1) << (BITS * LEVELS)))
+            due = now + (uint64_t(1) << (BITS * LEVELS)) - 1;
+
+        unsigned int s = (unsigned int)(due >> (BITS * l)) & (SLOTS - 1);
+        if(tails[l][s])
+            tails[l][s]->Next = n;
+        else
+            heads[l][s] = n;
+        tails[l][s] = n;
+        used[l] |= uint64_t(1) << s;
+    }
+
+    // Fires the timers of a list due up to tick, and puts back the ones that stay
+    template <typename Fire>
+    void fireList(Node *n, uint64_t tick, Fire &fire)
+    {
+        while(n){
+            Node *next = n->Next;
+            n->Next = NULL;
+            // a far timer may still be waiting for its turn, and a repeating one that fell behind fires again
+            bool keep = true;
+            while(keep && n->Value.Due <= tick)
+                keep = fire(n->Value.Value, n->Value.Due);
+            if(keep)
+                place(n);
+            else {
+                NodePool<timer>::Shared().Release(n);
+                --count;
+            }
+            n = next;
+        }
+    }
+
+    void cascade(unsigned int l, unsigned int s)
+    {
+        Node *n = heads[l][s];
+        heads[l][s] = tails[l][s] = NULL;
+        used[l] &= ~(uint64_t(1) << s);
+        while(n){
+            Node *next = n->Next;
+            place(n);
+            n = next;
+        }
+    }
+
+    // The first tick from now on where a level 0 slot has timers to fire, or a slot of a higher level
+    // comes up with timers to move down. Each level's mask is rotated so that its bit 0 is the next slot
+    // to come up, and the lowest set bit is the first one with timers
+    uint64_t nextTick() const
+    {
+        uint64_t next = ~uint64_t(0);
+        for(unsigned int l = 0; l < LEVELS; l++){
+            if(!used[l])
+                continue;
+            unsigned int shift = BITS * l;
+            uint64_t first = (now + (uint64_t(1) << shift) - 1) >> shift;
+            unsigned int s = (unsigned int)first & (SLOTS - 1);
+            uint64_t ahead = s ? (used[l] >> s) | (used[l] << (SLOTS - s)) : used[l];
+            next = std::min(next, (first + lowestSlot(ahead)) << shift);
+        }
+        return next;
+    }
+
+    static unsigned int lowestSlot(uint64_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return (unsigned int)index;
+#else
+        return (unsigned int)__builtin_ctzll(mask);
+#endif
+    }
+};
+
+// Camera commands that run at a given time instead of right away: at an absolute time on the cameras'
+// clock, after a delay, and optionally again every so often. All the cameras share one timer wheel, so
+// cameras with nothing scheduled cost nothing and Update only looks at the ticks that went by, never at
+// the cameras. A command runs on the first Update at or after its time and is then queued like any other
+// (use QUEUE_PREEMPT on its layer to make it start right then even if the layer is busy). Times are
+// rounded to the nearest tick, the same way when scheduling and when updating, so Update(t) runs what was
+// scheduled at t; a command can run up to half a tick early. Repeat k runs at at + k * interval, worked out
+// from the first time rather than added up, so repeats don't drift.
+class CameraScheduler
+{
+public:
+    // Repeat a command until the scheduler is cleared
+    static const unsigned int FOREVER = ~0u;
+
+    // resolution is the length of a tick, in seconds
+    CameraScheduler(float resolution = 1.0f / 1000.0f) : Resolution(resolution), time(0) {}
+
+    const float Resolution;
+
+    // Runs the command at an absolute time, then every interval seconds, repeats more times
+    void Schedule(float at, const cameraCommand &command, float interval = 0, unsigned int repeats = 0)
+    {
+        scheduledCommand s;
+        s.Command = command;
+        s.At = at;
+        s.Interval = interval > 0 ? interval : 0;
+        s.Runs = 0;
+        s.Repeats = s.Interval > 0 ? repeats : 0;
+        wheel.Add(ticks(at), s);
+    }
+
+    // Runs the command delay seconds after the last Update
+    void After(float delay, const cameraCommand &command, float interval = 0, unsigned int repeats = 0)
+    {
+        Schedule(time + delay, command, interval, repeats);
+    }
+
+    // Commands waiting, counting a repeating one once
+    size_t Pending() const {
+        return wheel.Size();
+    }
+
+    void Clear() {
+        wheel.Clear();
+    }
+
+    // Applies the commands due up to now to a Camera, a vector<Camera> or a CameraSystem
+    // (see ApplyCameraCommand) and returns how many ran
+    template <typename Cameras>
+    unsigned int Update(float now, Cameras &cameras)
+    {
+        time = now;
+        if(now < 0)
+            return 0;
+        applier<Cameras> apply(*this, cameras);
+        wheel.Advance(ticks(now), apply);
+        return apply.Count;
+    }
+
+private:
+    struct scheduledCommand {
+        cameraCommand Command;
+        double At;                  // first run, in seconds
+        double Interval;            // in seconds, 0 runs once
+        unsigned int Runs;
+        unsigned int Repeats;
+    };
+
+    template <typename Cameras>
+    struct applier {
+        const CameraScheduler &Scheduler;
+        Cameras &Targets;
+        unsigned int Count;
+
+        applier(const CameraScheduler &scheduler, Cameras &targets) : Scheduler(scheduler), Targets(targets), Count(0) {}
+
+        bool operator()(scheduledCommand &s, uint64_t &due){
+            ApplyCameraCommand(s.Command, Targets);
+            Count++;
+            if(s.Repeats == 0)
+                return false;
+            if(s.Repeats != FOREVER)
+                s.Repeats--;
+            // rounded to a float like the times Update is given, and at least a tick later, for intervals
+            // shorter than a tick
+            s.Runs++;
+            due = std::max(Scheduler.ticks((float)(s.At + s.Runs * s.Interval)), due + 1);
+            return true;
+        }
+    };
+
+    TimerWheel<scheduledCommand> wheel;
+    float time;
+
+    // The one conversion from seconds to ticks, for scheduling and updating alike
+    uint64_t ticks(double seconds) const {
+        return seconds > 0 ? (uint64_t)std::floor(seconds / Resolution + 0.5) : 0;
+    }
+};
+#endif
@@ -0,0 +1,112 @@
+#ifndef CAMERA_SNAPSHOT_H
+#define CAMERA_SNAPSHOT_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_system.h>
+
+#include <atomic>
+
+// Everything a renderer reads from a camera in a frame, copied at one instant
+struct cameraSnapshot {
+    glm::mat4 View;
+    glm::mat4 Projection;
+    glm::mat4 ViewProjection;
+    glm::vec3 Position;
+    glm::vec3 Front;
+    glm::vec3 Up;
+    glm::vec3 Right;
+    glm::quat Orientation;
+    float Zoom;
+    float Near;
+    float Far;
+    float Time;
+};
+
+// Brings the camera up to its clock (see Camera::GetViewMatrix) and copies its pose and matrices
+inline void CaptureSnapshot(Camera &camera, float width, float height, cameraSnapshot &s)
+{
+    // only GetViewMatrix reads the clock, so everything below is from the same instant
+    s.View = camera.GetViewMatrix();
+    s.Projection = camera.GetProjectionMatrix(width, height);
+    s.ViewProjection = s.Projection * s.View;
+    s.Position = camera.Position;
+    s.Front = camera.Front;
+    s.Up = camera.Up;
+    s.Right = camera.Right;
+    s.Orientation = camera.Orientation;
+    s.Zoom = camera.Zoom;
+    s.Near = camera.Near;
+    s.Far = camera.Far;
+    s.Time = camera.currTime;
+}
+
+// A camera of a system, as of its last Update
+inline void CaptureSnapshot(CameraSystem &system, unsigned int id, float width, float height, cameraSnapshot &s)
+{
+    s.View = system.GetViewMatrix(id);
+    s.Projection = system.GetProjectionMatrix(id, width, height);
+    s.ViewProjection = s.Projection * s.View;
+    s.Position = system.Position.get(id);
+    s.Front = system.Front.get(id);
+    s.Up = system.Up.get(id);
+    s.Right = system.Right.get(id);
+    s.Orientation = system.Orientation[id];
+    s.Zoom = system.Zoom[id];
+    s.Near = system.Near[id];
+    s.Far = system.Far[id];
+    s.Time = system.Time;
+}
+
+// Hands values from one writer thread to one reader thread without either ever waiting. The writer
+// fills its own buffer and publishes it by swapping it with the spare one; the reader swaps the spare
+// one with its own when something new was published. Each side only touches its buffer, so the reader
+// always sees a whole value, the latest one published, and the writer can run faster or slower than it.
+// T can be a vector (e.g. one snapshot per camera): the three buffers keep their memory between frames.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : back(0), spare(1), front(2) {}
+
+    // Writer side: the buffer to fill, then Publish it
+    T &Back() {
+        return buffers[back];
+    }
+
+    void Publish() {
+        back = spare.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side: takes the latest published value, if there is a new one, and returns whether there was
+    bool Update()
+    {
+        if(!(spare.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        front = spare.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // The value taken by the last Update. Default-constructed until something is published and taken
+    const T &Front() const {
+        return buffers[front];
+    }
+
+private:
+    static const unsigned int INDEX = 3;
+    static const unsigned int FRESH = 4;      // the spare buffer holds a value the reader hasn't taken
+
+    T buffers[3];
+    unsigned int back;
+    // the writer and the reader each keep their index on their own cache line
+    char writerPadding[64];
+    std::atomic<unsigned int> spare;
+    char readerPadding[64];
+    unsigned int front;
+
+    TripleBuffer(const TripleBuffer &);
+    TripleBuffer &operator=(const TripleBuffer &);
+};
+#endif
@@ -0,0 +1,842 @@
+#ifndef CAMERA_SYSTEM_H
+#define CAMERA_SYSTEM_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/spline.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_matrices.h>
+#include <learnopengl/camera_noise.h>
+#include <learnopengl/camera_orientation.h>
+#include <learnopengl/camera_path.h>
+#include <learnopengl/camera_policy.h>
+#include <learnopengl/camera_pool.h>
+#include <learnopengl/spline_path.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Three float arrays, one per component, so loops over many cameras read contiguous memory
+struct Vec3Array {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    void push_back(glm::vec3 v){
+        x.push_back(v.x);
+        y.push_back(v.y);
+        z.push_back(v.z);
+    }
+
+    glm::vec3 get(unsigned int i) const {
+        return glm::vec3(x[i], y[i], z[i]);
+    }
+
+    void set(unsigned int i, glm::vec3 v){
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+};
+
+// Threads kept from one CameraSystem::Update to the next, so a frame only wakes them instead of creating
+// them. They start on the first Run that needs them and stop with their owner; copies start with none.
+class cameraWorkers
+{
+public:
+    typedef void (*Job)(void *context, unsigned int part);
+
+    cameraWorkers() : job(NULL), context(NULL), parts(0), generation(0), running(0), stop(false) {}
+    cameraWorkers(const cameraWorkers &) : job(NULL), context(NULL), parts(0), generation(0), running(0), stop(false) {}
+
+    cameraWorkers &operator=(const cameraWorkers &) {
+        return *this;
+    }
+
+    ~cameraWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for(unsigned int i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    // Runs job(context, part) for every part in [0, parts), part 0 on the calling thread and the others on
+    // the workers, and returns when all of them are done
+    void Run(Job job, void *context, unsigned int parts)
+    {
+        while(threads.size() + 1 < parts)
+            threads.push_back(std::thread(&cameraWorkers::work, this, (unsigned int)threads.size() + 1, generation));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->job = job;
+            this->context = context;
+            this->parts = parts;
+            running = parts - 1;
+            generation++;
+        }
+        wake.notify_all();
+
+        job(context, 0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while(running)
+            done.wait(lock);
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;       // a new Run, or stop
+    std::condition_variable done;       // the last part finished
+    // guarded by mutex
+    Job job;
+    void *context;
+    unsigned int parts;
+    unsigned long long generation;      // Runs so far
+    unsigned int running;               // parts still being run by the workers
+    bool stop;
+
+    // seen: the last Run this worker knows about
+    void work(unsigned int part, unsigned long long seen)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(;;){
+            while(!stop && generation == seen)
+                wake.wait(lock);
+            if(stop)
+                return;
+            seen = generation;
+            if(part >= parts)
+                continue;
+
+            Job j = job;
+            void *c = context;
+            lock.unlock();
+            j(c, part);
+            lock.lock();
+            if(--running == 0)
+                done.notify_one();
+        }
+    }
+};
+
+// Stores many cameras as structure-of-arrays and advances all of them in one pass per frame.
+// Each camera follows the same rules as Camera::ProcessTransformations: every kind of transformation
+// has its own queue, and the channels are applied in the same order (bSpline, bezier, path, spline, translation, RP, RA, lookAt).
+// All the layers have weight 1 and the default priorities here (see camera_layers.h), and every camera
+// shares the same queue policies (see camera_policy.h).
+class CameraSystem
+{
+public:
+    // Hot pose data, one entry per camera
+    Vec3Array Position;
+    Vec3Array Front;
+    Vec3Array Up;
+    Vec3Array Right;
+    Vec3Array WorldUp;
+    std::vector<glm::quat> Orientation;
+
+    std::vector<float> Zoom;
+    std::vector<float> Near;
+    std::vector<float> Far;
+
+    // Time of the last Update, in seconds
+    float Time;
+
+    // Obstacles the cameras can't be moved through, or NULL, with the radius of every camera. See Camera::Collider
+    const CameraCollider *Collider;
+    float CollisionRadius;
+
+    CameraSystem() : Time(0), Collider(NULL), CollisionRadius(0.25f), updateChunk(0) {}
+
+    // Adds a camera and returns its id
+    unsigned int Add(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f), float zoom = ZOOM, float near = NEAR, float far = FAR)
+    {
+        unsigned int id = Size();
+
+        Position.push_back(position);
+        collisionFrom.push_back(position);
+        Front.push_back(front);
+        Up.push_back(up);
+        Right.push_back(glm::vec3(0));
+        WorldUp.push_back(up);
+        Orientation.push_back(glm::quat());
+        matrices.push_back(cameraMatrices());
+
+        noiseActive.push_back(0);
+        noise.push_back(cameraNoise());
+        noiseOffset.push_back(glm::vec3(0));
+        noiseRotation.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        Zoom.push_back(zoom);
+        Near.push_back(near);
+        Far.push_back(far);
+
+        lookAtQueues.push_back(PoolQueue<lookAt>());
+        translationQueues.push_back(PoolQueue<translation>());
+        rotationRPQueues.push_back(PoolQueue<rotationRP>());
+        rotationRAQueues.push_back(PoolQueue<rotationRA>());
+        bSplineQueues.push_back(PoolQueue<spline>());
+        bezierQueues.push_back(PoolQueue<spline>());
+        pathQueues.push_back(PoolQueue<pathFollow>());
+        splineQueues.push_back(PoolQueue<splineFollow>());
+        pending.push_back(0);
+
+        translationActive.push_back(0);
+        translationStart.push_back(0);
+        translationInvDuration.push_back(0);
+        translationFrom.push_back(glm::vec3(0));
+        translationTo.push_back(glm::vec3(0));
+
+        lookAtActive.push_back(0);
+        lookAtStart.push_back(0);
+        lookAtInvDuration.push_back(0);
+        lookAtRotation.push_back(orientationSlerp());
+
+        bezierActive.push_back(0);
+        bezierStart.push_back(0);
+        bezierInvDuration.push_back(0);
+        bezierP0.push_back(glm::vec3(0));
+        bezierP1.push_back(glm::vec3(0));
+        bezierP2.push_back(glm::vec3(0));
+        bezierP3.push_back(glm::vec3(0));
+
+        pathActive.push_back(0);
+        pathStart.push_back(0);
+        pathInvDuration.push_back(0);
+        pathCurrent.push_back(NULL);
+        pathLookAhead.push_back(-1.0f);
+
+        splineActive.push_back(0);
+        splineCurrent.push_back(splineFollow());
+
+        bSplineActive.push_back(0);
+        bSplineStart.push_back(0);
+        bSplineInvDuration.push_back(0);
+        bSplineCurrent.push_back(spline());
+
+        rotationRAActive.push_back(0);
+        rotationRACurrent.push_back(rotationRA());
+        rotationRPActive.push_back(0);
+        rotationRPCurrent.push_back(rotationRP());
+
+        updateCameraVectors(id);
+        return id;
+    }
+
+    unsigned int Size() const {
+        return (unsigned int)Zoom.size();
+    }
+
+    void LookAt(unsigned int id, glm::vec3 P, float time){
+        lookAt l;
+        l.Position = P;
+        l.FinalTime = time;
+        l.Started = false;
+
+        enqueue(id, lookAtQueues[id], l, LAYER_LOOKAT, LOOKAT_PENDING, lookAtActive);
+    }
+
+    void Translate(unsigned int id, glm::vec3 P, float time){
+        translation t;
+        t.Position = P;
+        t.FinalTime = time;
+        t.Started = false;
+
+        enqueue(id, translationQueues[id], t, LAYER_TRANSLATION, TRANSLATION_PENDING, translationActive);
+    }
+
+    void rotateRP(unsigned int id, glm::vec3 P, float angle, float time){
+        rotationRP r;
+        r.Point = P;
+        r.Angle = angle;
+        r.FinalTime = time;
+        r.Started = false;
+
+        enqueue(id, rotationRPQueues[id], r, LAYER_RP, RP_PENDING, rotationRPActive);
+    }
+
+    void rotateRA(unsigned int id, glm::vec3 axis, float angle, float time){
+        rotationRA r;
+        r.Axis = axis;
+        r.Angle = angle;
+        r.FinalTime = time;
+        r.Started = false;
+
+        enqueue(id, rotationRAQueues[id], r, LAYER_RA, RA_PENDING, rotationRAActive);
+    }
+
+    void bSplinePath(unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+        enqueue(id, bSplineQueues[id], makeSpline(P0, P1, P2, P3, time), LAYER_BSPLINE, BSPLINE_PENDING, bSplineActive);
+    }
+
+    void bezierPath(unsigned int id, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+        enqueue(id, bezierQueues[id], makeSpline(P0, P1, P2, P3, time), LAYER_BEZIER, BEZIER_PENDING, bezierActive);
+    }
+
+    // Moves along a prebuilt path at constant speed, see Camera::followPath.
+    // The path is not copied, it must outlive the transformation
+    void followPath(unsigned int id, const CameraPath *path, float time, bool orient = false, float lookAhead = 0.0f){
+        pathFollow p;
+        p.Path = path;
+        p.LookAhead = orient ? std::max(lookAhead, 0.0f) : -1.0f;
+        p.FinalTime = time;
+        p.Started = false;
+
+        enqueue(id, pathQueues[id], p, LAYER_PATH, PATH_PENDING, pathActive);
+    }
+
+    // Follows a spline path with any number of points, using the path's own segment times.
+    // The path is not copied, it must outlive the transformation
+    void followSpline(unsigned int id, const SplinePath *path){
+        splineFollow s;
+        s.Path = path;
+        s.Cursor = 0;
+        s.Started = false;
+
+        enqueue(id, splineQueues[id], s, LAYER_SPLINE, SPLINE_PENDING, splineActive);
+    }
+
+    // How every camera's queue for a layer treats new transformations, see Camera::setQueuePolicy
+    void SetQueuePolicy(CameraLayer layer, QueuePolicy policy, unsigned int maxDepth = 0){
+        policies[layer].Policy = policy;
+        policies[layer].MaxDepth = maxDepth;
+    }
+
+    // Shakes the view of a camera with Perlin noise, see Camera::StartNoise
+    void StartNoise(unsigned int id, float amplitude, float rotationAmplitude, float frequency = 1.0f, unsigned int octaves = 3, float phase = 0.0f){
+        cameraNoise &n = noise[id];
+        n.Amplitude = amplitude;
+        n.RotationAmplitude = rotationAmplitude;
+        n.Frequency = frequency;
+        n.Octaves = octaves;
+        n.Phase = phase;
+        noiseActive[id] = 1;
+    }
+
+    void StopNoise(unsigned int id){
+        noiseActive[id] = 0;
+        noiseOffset.set(id, glm::vec3(0));
+        noiseRotation[id] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    // Puts a camera at a position and orientation, see Camera::setPose
+    void SetPose(unsigned int id, glm::vec3 position, glm::quat orientation){
+        Position.set(id, position);
+        Orientation[id] = orientation;
+        updateFromOrientation(id);
+    }
+
+    // Advances every camera to currTime. With threads > 1 the cameras are split in contiguous ranges,
+    // one per thread; cameras never share state, so no synchronization is needed inside the pass.
+    // The threads are created by the first Update that asks for them and reused by the next ones
+    void Update(float currTime, unsigned int threads = 1)
+    {
+        Time = currTime;
+        unsigned int count = Size();
+        if(count == 0)
+            return;
+        if(threads <= 1 || count < 2 * threads){
+            updateRange(currTime, 0, count);
+            return;
+        }
+
+        updateChunk = (count + threads - 1) / threads;
+        workers.Run(&CameraSystem::updatePart, this, (count + updateChunk - 1) / updateChunk);
+    }
+
+    // Moves every camera forward by dt seconds from the last Update
+    void Advance(float dt, unsigned int threads = 1)
+    {
+        Update(Time + dt, threads);
+    }
+
+    // Returns the view matrix of the camera as of the last Update.
+    // The matrices are cached per camera and only rebuilt when the values they come from changed
+    glm::mat4 GetViewMatrix(unsigned int id)
+    {
+        return matrices[id].GetView(viewPosition(id), Orientation[id] * noiseRotation[id]);
+    }
+
+    // Returns projection matrix for width and height screen values
+    glm::mat4 GetProjectionMatrix(unsigned int id, float width, float height)
+    {
+        return matrices[id].GetProjection(Zoom[id], width / height, Near[id], Far[id]);
+    }
+
+    // Returns projection * view
+    glm::mat4 GetViewProjectionMatrix(unsigned int id, float width, float height)
+    {
+        return matrices[id].GetViewProjection(viewPosition(id), Orientation[id] * noiseRotation[id], Zoom[id], width / height, Near[id], Far[id]);
+    }
+
+private:
+    std::vector<cameraMatrices> matrices;
+
+    cameraWorkers workers;
+    unsigned int updateChunk;           // cameras per thread in the current Update
+    // positions before the current Update, for the collider
+    Vec3Array collisionFrom;
+
+    // Noise parameters and the offsets from the last Update, in each camera's frame
+    std::vector<unsigned char> noiseActive;
+    std::vector<cameraNoise> noise;
+    Vec3Array noiseOffset;
+    std::vector<glm::quat> noiseRotation;
+
+    enum PendingBits {
+        LOOKAT_PENDING      = 1 << 0,
+        TRANSLATION_PENDING = 1 << 1,
+        RP_PENDING          = 1 << 2,
+        RA_PENDING          = 1 << 3,
+        BSPLINE_PENDING     = 1 << 4,
+        BEZIER_PENDING      = 1 << 5,
+        PATH_PENDING        = 1 << 6,
+        SPLINE_PENDING      = 1 << 7
+    };
+
+    // One bit per non-empty queue, so the start passes never touch the queues of idle cameras
+    std::vector<unsigned char> pending;
+
+    queuePolicy policies[CAMERA_LAYERS];
+
+    // Cold storage: commands waiting for their channel to become free
+    std::vector< PoolQueue<lookAt> > lookAtQueues;
+    std::vector< PoolQueue<translation> > translationQueues;
+    std::vector< PoolQueue<rotationRP> > rotationRPQueues;
+    std::vector< PoolQueue<rotationRA> > rotationRAQueues;
+    std::vector< PoolQueue<spline> > bSplineQueues;
+    std::vector< PoolQueue<spline> > bezierQueues;
+    std::vector< PoolQueue<pathFollow> > pathQueues;
+    std::vector< PoolQueue<splineFollow> > splineQueues;
+
+    // Active transformations. The position channels keep one array per field so their evaluation
+    // loops have no branches and can be vectorized; the orientation channels are evaluated per camera.
+    std::vector<unsigned char> translationActive;
+    std::vector<float> translationStart;
+    std::vector<float> translationInvDuration;
+    Vec3Array translationFrom;
+    Vec3Array translationTo;
+
+    std::vector<unsigned char> lookAtActive;
+    std::vector<float> lookAtStart;
+    std::vector<float> lookAtInvDuration;
+    std::vector<orientationSlerp> lookAtRotation;
+
+    std::vector<unsigned char> bezierActive;
+    std::vector<float> bezierStart;
+    std::vector<float> bezierInvDuration;
+    Vec3Array bezierP0;
+    Vec3Array bezierP1;
+    Vec3Array bezierP2;
+    Vec3Array bezierP3;
+
+    std::vector<unsigned char> pathActive;
+    std::vector<float> pathStart;
+    std::vector<float> pathInvDuration;
+    std::vector<const CameraPath *> pathCurrent;
+    std::vector<float> pathLookAhead;
+
+    std::vector<unsigned char> splineActive;
+    std::vector<splineFollow> splineCurrent;
+
+    std::vector<unsigned char> bSplineActive;
+    std::vector<float> bSplineStart;
+    std::vector<float> bSplineInvDuration;
+    std::vector<spline> bSplineCurrent;
+
+    std::vector<unsigned char> rotationRAActive;
+    std::vector<rotationRA> rotationRACurrent;
+    std::vector<unsigned char> rotationRPActive;
+    std::vector<rotationRP> rotationRPCurrent;
+
+    // The running transformation has already left its queue here, so preempting it clears its flag
+    template <typename T>
+    void enqueue(unsigned int id, PoolQueue<T> &queue, const T &value, CameraLayer layer, unsigned char bit, std::vector<unsigned char> &active){
+        const queuePolicy &policy = policies[layer];
+        if(policy.Policy == QUEUE_PREEMPT)
+            active[id] = 0;
+        EnqueueTransformation(queue, value, policy);
+        pending[id] |= bit;
+    }
+
+    static spline makeSpline(glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3, float time){
+        spline b;
+        b.p0 = P0;
+        b.p1 = P1;
+        b.p2 = P2;
+        b.p3 = P3;
+        b.Time = time;
+        b.Started = false;
+        return b;
+    }
+
+    // Converts a duration into the reciprocal used by the evaluation loops.
+    // A zero duration finishes on the first evaluation instead of dividing by zero.
+    static void setTiming(float currTime, float duration, float &start, float &invDuration){
+        if(duration > 0){
+            start = currTime;
+            invDuration = 1.0f / duration;
+        }
+        else {
+            start = currTime - 1.0f;
+            invDuration = 1.0f;
+        }
+    }
+
+    static void updatePart(void *context, unsigned int part)
+    {
+        CameraSystem *system = (CameraSystem *)context;
+        unsigned int begin = part * system->updateChunk;
+        system->updateRange(system->Time, begin, std::min(begin + system->updateChunk, system->Size()));
+    }
+
+    void updateRange(float currTime, unsigned int begin, unsigned int end)
+    {
+        if(Collider)
+            for(unsigned int i = begin; i < end; i++)
+                collisionFrom.set(i, Position.get(i));
+
+        processBSpline(currTime, begin, end);
+        processBezier(currTime, begin, end);
+        processPath(currTime, begin, end);
+        processSpline(currTime, begin, end);
+        processTranslation(currTime, begin, end);
+
+        processRP(currTime, begin, end);
+        processRA(currTime, begin, end);
+
+        processLookAt(currTime, begin, end);
+
+        if(Collider)
+            processCollision(begin, end);
+
+        processNoise(currTime, begin, end);
+    }
+
+    // Stops the cameras the transformations moved at the obstacles between their old and new positions
+    void processCollision(unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            glm::vec3 from = collisionFrom.get(i), to = Position.get(i);
+            if(from != to)
+                Position.set(i, Collider->Move(from, to, CollisionRadius));
+        }
+    }
+
+    glm::vec3 viewPosition(unsigned int id) const
+    {
+        return Position.get(id) + Orientation[id] * noiseOffset.get(id);
+    }
+
+    // All the shaking cameras read the same shared table
+    void processNoise(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!noiseActive[i])
+                continue;
+
+            glm::vec3 offset;
+            noise[i].Evaluate(currTime, offset, noiseRotation[i]);
+            noiseOffset.set(i, offset);
+        }
+    }
+
+    void processBSpline(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!bSplineActive[i] && (pending[i] & BSPLINE_PENDING)){
+                bSplineCurrent[i] = bSplineQueues[i].front();
+                bSplineQueues[i].pop();
+                if(bSplineQueues[i].empty())
+                    pending[i] &= ~BSPLINE_PENDING;
+                setTiming(currTime, bSplineCurrent[i].Time, bSplineStart[i], bSplineInvDuration[i]);
+                bSplineActive[i] = 1;
+            }
+            if(!bSplineActive[i])
+                continue;
+
+            const spline &b = bSplineCurrent[i];
+            float percentage = (currTime - bSplineStart[i]) * bSplineInvDuration[i];
+            if(percentage >= 1){
+                bSplineActive[i] = 0;
+                Position.set(i, b.p3);
+                continue;
+            }
+
+            glm::vec3 v;
+            if(percentage <= 0.333333333f)
+                v = glm::catmullRom(b.p0, b.p0, b.p1, b.p2, 3 * percentage);
+            else if(percentage <= 0.666666666f)
+                v = glm::catmullRom(b.p0, b.p1, b.p2, b.p3, 3 * (percentage - 0.333333333f));
+            else
+                v = glm::catmullRom(b.p1, b.p2, b.p3, b.p3, 3 * (percentage - 0.666666666f));
+            Position.set(i, v);
+        }
+    }
+
+    void processBezier(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!bezierActive[i] && (pending[i] & BEZIER_PENDING)){
+                const spline &b = bezierQueues[i].front();
+                bezierP0.set(i, b.p0);
+                bezierP1.set(i, b.p1);
+                bezierP2.set(i, b.p2);
+                bezierP3.set(i, b.p3);
+                setTiming(currTime, b.Time, bezierStart[i], bezierInvDuration[i]);
+                bezierActive[i] = 1;
+                bezierQueues[i].pop();
+                if(bezierQueues[i].empty())
+                    pending[i] &= ~BEZIER_PENDING;
+            }
+        }
+
+        unsigned char *active = &bezierActive[0];
+        const float *start = &bezierStart[0], *invDuration = &bezierInvDuration[0];
+        evaluateBezier(currTime, begin, end, active, start, invDuration, bezierP0.x, bezierP1.x, bezierP2.x, bezierP3.x, Position.x);
+        evaluateBezier(currTime, begin, end, active, start, invDuration, bezierP0.y, bezierP1.y, bezierP2.y, bezierP3.y, Position.y);
+        evaluateBezier(currTime, begin, end, active, start, invDuration, bezierP0.z, bezierP1.z, bezierP2.z, bezierP3.z, Position.z);
+        for(unsigned int i = begin; i < end; i++)
+            active[i] = active[i] && (currTime - start[i]) * invDuration[i] < 1;
+    }
+
+    // One component of the cubic Bezier in Bernstein form, evaluated with Horner's rule instead of pow()
+    static void evaluateBezier(float currTime, unsigned int begin, unsigned int end, const unsigned char *active, const float *start, const float *invDuration,
+                               const std::vector<float> &p0, const std::vector<float> &p1, const std::vector<float> &p2, const std::vector<float> &p3, std::vector<float> &out)
+    {
+        const float *a = &p0[0], *b = &p1[0], *c = &p2[0], *d = &p3[0];
+        float *o = &out[0];
+        for(unsigned int i = begin; i < end; i++){
+            float t = std::min(std::max((currTime - start[i]) * invDuration[i], 0.0f), 1.0f);
+            float c1 = 3 * (b[i] - a[i]);
+            float c2 = 3 * (c[i] - 2 * b[i] + a[i]);
+            float c3 = d[i] - a[i] + 3 * (b[i] - c[i]);
+            float v = a[i] + t * (c1 + t * (c2 + t * c3));
+            o[i] = active[i] ? v : o[i];
+        }
+    }
+
+    // Paths are already arc-length tables, so each active camera costs one table lookup
+    void processPath(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!pathActive[i] && (pending[i] & PATH_PENDING)){
+                const pathFollow &p = pathQueues[i].front();
+                pathCurrent[i] = p.Path;
+                pathLookAhead[i] = p.LookAhead;
+                setTiming(currTime, p.FinalTime, pathStart[i], pathInvDuration[i]);
+                pathActive[i] = 1;
+                pathQueues[i].pop();
+                if(pathQueues[i].empty())
+                    pending[i] &= ~PATH_PENDING;
+            }
+            if(!pathActive[i])
+                continue;
+
+            float percentage = (currTime - pathStart[i]) * pathInvDuration[i];
+            const CameraPath *path = pathCurrent[i];
+            Position.set(i, path->Sample(percentage));
+            if(pathLookAhead[i] >= 0){
+                Orientation[i] = path->SampleOrientation(percentage + (path->Length > 0 ? pathLookAhead[i] / path->Length : 0));
+                updateFromOrientation(i);
+            }
+            pathActive[i] = percentage < 1;
+        }
+    }
+
+    // Each follower keeps its own cursor, so the segment lookup is O(1) while time moves forward
+    void processSpline(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!splineActive[i] && (pending[i] & SPLINE_PENDING)){
+                splineCurrent[i] = splineQueues[i].front();
+                splineCurrent[i].InicialTime = currTime;
+                splineActive[i] = 1;
+                splineQueues[i].pop();
+                if(splineQueues[i].empty())
+                    pending[i] &= ~SPLINE_PENDING;
+            }
+            if(!splineActive[i])
+                continue;
+
+            splineFollow &s = splineCurrent[i];
+            float time = currTime - s.InicialTime;
+            Position.set(i, s.Path->Evaluate(time, s.Cursor));
+            splineActive[i] = time < s.Path->Duration();
+        }
+    }
+
+    void processTranslation(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!translationActive[i] && (pending[i] & TRANSLATION_PENDING)){
+                const translation &t = translationQueues[i].front();
+                translationFrom.set(i, Position.get(i));
+                translationTo.set(i, t.Position);
+                setTiming(currTime, t.FinalTime, translationStart[i], translationInvDuration[i]);
+                translationActive[i] = 1;
+                translationQueues[i].pop();
+                if(translationQueues[i].empty())
+                    pending[i] &= ~TRANSLATION_PENDING;
+            }
+        }
+
+        unsigned char *active = &translationActive[0];
+        const float *start = &translationStart[0], *invDuration = &translationInvDuration[0];
+        evaluateLerp(currTime, begin, end, active, start, invDuration, translationFrom.x, translationTo.x, Position.x);
+        evaluateLerp(currTime, begin, end, active, start, invDuration, translationFrom.y, translationTo.y, Position.y);
+        evaluateLerp(currTime, begin, end, active, start, invDuration, translationFrom.z, translationTo.z, Position.z);
+        for(unsigned int i = begin; i < end; i++)
+            active[i] = active[i] && (currTime - start[i]) * invDuration[i] < 1;
+    }
+
+    static void evaluateLerp(float currTime, unsigned int begin, unsigned int end, const unsigned char *active, const float *start, const float *invDuration,
+                             const std::vector<float> &from, const std::vector<float> &to, std::vector<float> &out)
+    {
+        const float *a = &from[0], *b = &to[0];
+        float *o = &out[0];
+        for(unsigned int i = begin; i < end; i++){
+            float t = std::min(std::max((currTime - start[i]) * invDuration[i], 0.0f), 1.0f);
+            float v = a[i] + t * (b[i] - a[i]);
+            o[i] = active[i] ? v : o[i];
+        }
+    }
+
+    void processRA(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!rotationRAActive[i]){
+                if(!(pending[i] & RA_PENDING))
+                    continue;
+                rotationRA &r = rotationRACurrent[i];
+                r = rotationRAQueues[i].front();
+                rotationRAQueues[i].pop();
+                if(rotationRAQueues[i].empty())
+                    pending[i] &= ~RA_PENDING;
+                r.InicialTime = currTime;
+                r.FinalTime += currTime;
+                r.InicialFront = Front.get(i);
+                r.InicialPosition = Position.get(i);
+                r.InicialUp = Up.get(i);
+                r.Rotor.Set(Orientation[i], r.Axis);
+                rotationRAActive[i] = 1;
+            }
+
+            rotationRA &r = rotationRACurrent[i];
+            float percentage = r.FinalTime > r.InicialTime ? (currTime - r.InicialTime) / (r.FinalTime - r.InicialTime) : 1;
+
+            // Same direction as Camera::ProcessRA
+            if(percentage >= 1){
+                rotationRAActive[i] = 0;
+                Orientation[i] = r.Rotor.Exact(-r.Angle);
+            }
+            else {
+                Orientation[i] = r.Rotor.Advance(-r.Angle * percentage);
+            }
+
+            updateFromOrientation(i);
+        }
+    }
+
+    void processRP(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!rotationRPActive[i]){
+                if(!(pending[i] & RP_PENDING))
+                    continue;
+                rotationRP &r = rotationRPCurrent[i];
+                r = rotationRPQueues[i].front();
+                rotationRPQueues[i].pop();
+                if(rotationRPQueues[i].empty())
+                    pending[i] &= ~RP_PENDING;
+                r.InicialTime = currTime;
+                r.FinalTime += currTime;
+
+                glm::vec3 position = Position.get(i), front = Front.get(i);
+                r.InicialFront = front;
+                r.InicialPosition = position;
+                r.InicialUp = Up.get(i);
+
+                glm::vec3 newFront = glm::normalize(r.Point != position ? r.Point - position : front);
+                if(newFront != front && (newFront + front) != glm::vec3(0)){
+                    glm::vec3 up = glm::normalize(glm::cross(front, newFront));
+                    if(up.y <= 0.0)
+                        up *= -1;
+                    Up.set(i, up);
+                }
+                rotationRPActive[i] = 1;
+            }
+
+            const rotationRP &r = rotationRPCurrent[i];
+            float percentage = r.FinalTime > r.InicialTime ? (currTime - r.InicialTime) / (r.FinalTime - r.InicialTime) : 1;
+            if(percentage >= 1){
+                percentage = 1;
+                rotationRPActive[i] = 0;
+            }
+
+            glm::mat4 rMatrix = glm::mat4(1);
+            rMatrix = glm::translate(rMatrix, r.Point);
+            rMatrix = glm::rotate(rMatrix, r.Angle * percentage, Up.get(i));
+            rMatrix = glm::translate(rMatrix, -r.Point);
+
+            glm::vec4 newPosition = glm::vec4(r.InicialPosition, 1) * rMatrix;
+            Position.set(i, glm::vec3(newPosition));
+            updateCameraVectors(i);
+        }
+    }
+
+    void processLookAt(float currTime, unsigned int begin, unsigned int end)
+    {
+        for(unsigned int i = begin; i < end; i++){
+            if(!lookAtActive[i] && (pending[i] & LOOKAT_PENDING)){
+                lookAt l = lookAtQueues[i].front();
+                lookAtQueues[i].pop();
+                if(lookAtQueues[i].empty())
+                    pending[i] &= ~LOOKAT_PENDING;
+
+                glm::vec3 position = Position.get(i);
+                if(position == l.Position)
+                    continue;
+
+                glm::vec3 finalFront = glm::normalize(l.Position - position);
+                lookAtRotation[i].Set(Orientation[i], OrientationFromVectors(finalFront, WorldUp.get(i), Up.get(i)));
+                setTiming(currTime, l.FinalTime, lookAtStart[i], lookAtInvDuration[i]);
+                lookAtActive[i] = 1;
+            }
+            if(!lookAtActive[i])
+                continue;
+
+            float percentage = std::min((currTime - lookAtStart[i]) * lookAtInvDuration[i], 1.0f);
+            Orientation[i] = lookAtRotation[i].At(percentage);
+            updateFromOrientation(i);
+            lookAtActive[i] = percentage < 1;
+        }
+    }
+
+    // Same as Camera::updateCameraVectors
+    void updateCameraVectors(unsigned int i)
+    {
+        glm::vec3 front = glm::normalize(Front.get(i));
+        Front.set(i, front);
+        Orientation[i] = OrientationFromVectors(front, WorldUp.get(i), Up.get(i));
+        updateFromOrientation(i);
+    }
+
+    void updateFromOrientation(unsigned int i)
+    {
+        glm::quat q = Orientation[i];
+        Front.set(i, q * glm::vec3(0.0f, 0.0f, -1.0f));
+        Right.set(i, q * glm::vec3(1.0f, 0.0f, 0.0f));
+        Up.set(i, q * glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+};
+#endif
@@ -0,0 +1,128 @@
+#ifndef CAMERA_TRACK_H
+#define CAMERA_TRACK_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/camera_trajectory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// A camera's choreography baked into keyframes (see Camera::bakeTrack). Playing it back is a
+// binary search for the keyframe (O(1) while time moves forward) and a lerp / slerp, whatever
+// transformations it was baked from.
+class CameraTrack
+{
+public:
+    // Keyframes, in increasing time from 0
+    std::vector<float> Times;
+    std::vector<glm::vec3> Positions;
+    std::vector<glm::quat> Orientations;
+    std::vector<float> Zooms;
+    float Near;
+    float Far;
+
+    CameraTrack() : Near(0), Far(0) {}
+
+    // Appends a keyframe after the last one
+    void Add(float time, glm::vec3 position, glm::quat orientation, float zoom)
+    {
+        // take the short way to the previous keyframe, so the slerp between them never turns the long way round
+        if(!Orientations.empty() && glm::dot(orientation, Orientations.back()) < 0)
+            orientation = -orientation;
+
+        if(!Orientations.empty()){
+            float cosTheta = std::min(glm::dot(Orientations.back(), orientation), 1.0f);
+            float angle = cosTheta < 0.9995f ? std::acos(cosTheta) : 0.0f;
+            angles.push_back(angle);
+            invSins.push_back(angle > 0 ? 1.0f / std::sin(angle) : 0.0f);
+        }
+
+        Times.push_back(time);
+        Positions.push_back(position);
+        Orientations.push_back(orientation);
+        Zooms.push_back(zoom);
+    }
+
+    unsigned int Keys() const {
+        return (unsigned int)Times.size();
+    }
+
+    float Duration() const {
+        return Times.empty() ? 0 : Times.back();
+    }
+
+    // Keyframe k with Times[k] <= time < Times[k + 1], checking the cursor and the keyframe after it first
+    unsigned int FindKey(float time, unsigned int &cursor) const
+    {
+        unsigned int n = Keys();
+        if(cursor + 1 < n && time >= Times[cursor] && time < Times[cursor + 1])
+            return cursor;
+        if(cursor + 2 < n && time >= Times[cursor + 1] && time < Times[cursor + 2])
+            return ++cursor;
+
+        unsigned int k = (unsigned int)(std::upper_bound(Times.begin(), Times.end(), time) - Times.begin());
+        cursor = k > 0 ? k - 1 : 0;
+        if(cursor + 1 >= n)
+            cursor = n > 1 ? n - 2 : 0;
+        return cursor;
+    }
+
+    // Pose at a time in seconds, clamped to the track. An empty track gives DefaultTrajectoryPose
+    trajectoryPose Sample(float time, unsigned int &cursor) const
+    {
+        if(Times.empty())
+            return DefaultTrajectoryPose();
+
+        trajectoryPose p;
+        unsigned int k = FindKey(time, cursor);
+        float t = 0;
+        if(k + 1 < Keys()){
+            float span = Times[k + 1] - Times[k];
+            t = span > 0 ? std::min(std::max((time - Times[k]) / span, 0.0f), 1.0f) : 1.0f;
+        }
+        interpolate(k, t, p.Position, p.Orientation, p.Zoom);
+        p.Near = Near;
+        p.Far = Far;
+        return p;
+    }
+
+    // Poses at count times, written into contiguous arrays (zooms can be NULL).
+    // Times in increasing order cost O(1) each; other orders work too, with a binary search each
+    void Sample(const float *times, unsigned int count, glm::vec3 *positions, glm::quat *orientations, float *zooms = NULL) const
+    {
+        unsigned int cursor = 0;
+        for(unsigned int i = 0; i < count; i++){
+            trajectoryPose p = Sample(times[i], cursor);
+            positions[i] = p.Position;
+            orientations[i] = p.Orientation;
+            if(zooms)
+                zooms[i] = p.Zoom;
+        }
+    }
+
+private:
+    // Slerp angle between each keyframe and the next, and 1 / sin of it
+    std::vector<float> angles;
+    std::vector<float> invSins;
+
+    void interpolate(unsigned int k, float t, glm::vec3 &position, glm::quat &orientation, float &zoom) const
+    {
+        if(k + 1 >= Keys() || t <= 0){
+            position = Positions[k];
+            orientation = Orientations[k];
+            zoom = Zooms[k];
+            return;
+        }
+
+        position = Positions[k] + t * (Positions[k + 1] - Positions[k]);
+        zoom = Zooms[k] + t * (Zooms[k + 1] - Zooms[k]);
+        if(angles[k] == 0)
+            orientation = glm::normalize(Orientations[k] * (1 - t) + Orientations[k + 1] * t);
+        else
+            orientation = (Orientations[k] * std::sin((1 - t) * angles[k]) + Orientations[k + 1] * std::sin(t * angles[k])) * invSins[k];
+    }
+};
+#endif
@@ -0,0 +1,472 @@
+#ifndef CAMERA_TRAJECTORY_H
+#define CAMERA_TRAJECTORY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/mapped_file.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+// Binary camera trajectory files: poses sampled at a fixed rate, quantized to integers and stored as
+// the difference from the previous frame. A file is
+//
+//   trajectoryHeader
+//   blocks: trajectoryBlock (first frame, absolute values) followed by Frames - 1 trajectoryDelta
+//   block table: the file offset (uint64_t) of every block
+//
+// all little-endian. Blocks are at most TRAJECTORY_BLOCK_FRAMES long, so any frame is at most that many
+// deltas away from an absolute pose. A frame takes 16 bytes instead of the 40 of the floats it came from.
+
+const uint32_t TRAJECTORY_VERSION = 1;
+const unsigned int TRAJECTORY_BLOCK_FRAMES = 1024;
+// Field of view is stored in 1/256 degree steps and orientation components in 1/32767 steps
+const float TRAJECTORY_ZOOM_STEP = 1.0f / 256.0f;
+const float TRAJECTORY_ORIENTATION_SCALE = 32767.0f;
+
+struct trajectoryHeader {
+    char Magic[4];              // "CTRJ"
+    uint32_t Version;
+    float SampleRate;           // frames per second
+    float PositionStep;         // world units per position unit
+    uint32_t Frames;
+    uint32_t Blocks;
+    uint64_t BlockTable;        // file offset of the block table
+};
+
+struct trajectoryBlock {
+    uint32_t FirstFrame;
+    uint32_t Frames;
+    int32_t Position[3];
+    int16_t Orientation[4];     // w, x, y, z
+    int32_t Zoom;
+    float Near;                 // near and far only change between blocks
+    float Far;
+};
+
+// Change of every quantized value from the previous frame
+struct trajectoryDelta {
+    int16_t Position[3];
+    int16_t Orientation[4];
+    int16_t Zoom;
+};
+
+// One decoded frame
+struct trajectoryPose {
+    glm::vec3 Position;
+    glm::quat Orientation;
+    float Zoom;
+    float Near;
+    float Far;
+};
+
+// Pose of a new camera (see camera.h), for when there is nothing to decode
+inline trajectoryPose DefaultTrajectoryPose()
+{
+    trajectoryPose p;
+    p.Position = glm::vec3(0);
+    p.Orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    p.Zoom = 45.0f;
+    p.Near = 0.1f;
+    p.Far = 100.0f;
+    return p;
+}
+
+// Quantized values in the order of trajectoryDelta: position x, y, z, orientation w, x, y, z, zoom
+const unsigned int TRAJECTORY_VALUES = 8;
+
+// Where sequential playback is in a file. Moving forward only applies the deltas in between,
+// so playing a file from start to end decodes every frame once.
+struct trajectoryCursor {
+    unsigned int Block;
+    unsigned int Frame;         // frame the values belong to
+    int32_t Values[TRAJECTORY_VALUES];
+    bool Valid;
+    bool Damaged;               // a frame asked for is in a damaged block; the cursor stays where it was
+
+    trajectoryCursor() : Block(0), Frame(0), Valid(false), Damaged(false) {}
+};
+
+// Streams poses to a trajectory file. Only the block being filled and the block offsets are kept in memory,
+// so recordings can be as long as the disk allows.
+class TrajectoryWriter
+{
+public:
+    TrajectoryWriter() : file(NULL) {}
+
+    ~TrajectoryWriter() {
+        Close();
+    }
+
+    // positionStep is the smallest position change that is kept, in world units
+    bool Open(const char *path, float sampleRate, float positionStep = 1.0f / 1024.0f)
+    {
+        Close();
+        file = fopen(path, "wb");
+        if(!file)
+            return false;
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.Magic, "CTRJ", 4);
+        header.Version = TRAJECTORY_VERSION;
+        header.SampleRate = sampleRate;
+        header.PositionStep = positionStep;
+        offset = sizeof(header);
+        blockOffsets.clear();
+        deltas.clear();
+        block.Frames = 0;
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        return ok;
+    }
+
+    bool IsOpen() const {
+        return file != NULL;
+    }
+
+    // Appends the pose of the next frame
+    void Add(glm::vec3 position, glm::quat orientation, float zoom, float near, float far)
+    {
+        if(!file)
+            return;
+
+        // q and -q are the same orientation; keeping the sign continuous keeps the deltas small
+        if(header.Frames > 0 && glm::dot(orientation, lastOrientation) < 0)
+            orientation = -orientation;
+        lastOrientation = orientation;
+
+        int32_t v[TRAJECTORY_VALUES];
+        for(int i = 0; i < 3; i++)
+            v[i] = (int32_t)std::floor(position[i] / header.PositionStep + 0.5f);
+        glm::quat q = glm::normalize(orientation);
+        v[3] = (int32_t)std::floor(q.w * TRAJECTORY_ORIENTATION_SCALE + 0.5f);
+        v[4] = (int32_t)std::floor(q.x * TRAJECTORY_ORIENTATION_SCALE + 0.5f);
+        v[5] = (int32_t)std::floor(q.y * TRAJECTORY_ORIENTATION_SCALE + 0.5f);
+        v[6] = (int32_t)std::floor(q.z * TRAJECTORY_ORIENTATION_SCALE + 0.5f);
+        v[7] = (int32_t)std::floor(zoom / TRAJECTORY_ZOOM_STEP + 0.5f);
+
+        bool fits = block.Frames > 0 && block.Frames < TRAJECTORY_BLOCK_FRAMES && near == block.Near && far == block.Far;
+        trajectoryDelta d;
+        int16_t *dv[TRAJECTORY_VALUES] = { &d.Position[0], &d.Position[1], &d.Position[2], &d.Orientation[0], &d.Orientation[1], &d.Orientation[2], &d.Orientation[3], &d.Zoom };
+        for(unsigned int i = 0; fits && i < TRAJECTORY_VALUES; i++){
+            int64_t change = (int64_t)v[i] - last[i];
+            fits = change >= -32768 && change <= 32767;
+            *dv[i] = (int16_t)change;
+        }
+
+        if(fits){
+            deltas.push_back(d);
+            block.Frames++;
+        }
+        else {
+            flush();
+            block.FirstFrame = header.Frames;
+            block.Frames = 1;
+            for(int i = 0; i < 3; i++)
+                block.Position[i] = v[i];
+            for(int i = 0; i < 4; i++)
+                block.Orientation[i] = (int16_t)v[3 + i];
+            block.Zoom = v[7];
+            block.Near = near;
+            block.Far = far;
+        }
+        memcpy(last, v, sizeof(last));
+        header.Frames++;
+    }
+
+    // Writes the last block, the block table and the final header. Returns false if any write failed
+    bool Close()
+    {
+        if(!file)
+            return true;
+
+        flush();
+        header.Blocks = (uint32_t)blockOffsets.size();
+        header.BlockTable = offset;
+        if(!blockOffsets.empty())
+            ok = ok && fwrite(&blockOffsets[0], sizeof(uint64_t), blockOffsets.size(), file) == blockOffsets.size();
+        ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = fclose(file) == 0 && ok;
+        file = NULL;
+        return ok;
+    }
+
+private:
+    FILE *file;
+    trajectoryHeader header;
+    uint64_t offset;
+    bool ok;
+
+    std::vector<uint64_t> blockOffsets;
+    trajectoryBlock block;
+    std::vector<trajectoryDelta> deltas;
+    int32_t last[TRAJECTORY_VALUES];
+    glm::quat lastOrientation;
+
+    TrajectoryWriter(const TrajectoryWriter &);
+    TrajectoryWriter &operator=(const TrajectoryWriter &);
+
+    void flush()
+    {
+        if(block.Frames == 0)
+            return;
+
+        blockOffsets.push_back(offset);
+        ok = ok && fwrite(&block, sizeof(block), 1, file) == 1;
+        if(!deltas.empty())
+            ok = ok && fwrite(&deltas[0], sizeof(trajectoryDelta), deltas.size(), file) == deltas.size();
+        offset += sizeof(block) + deltas.size() * sizeof(trajectoryDelta);
+        deltas.clear();
+        block.Frames = 0;
+    }
+};
+
+// A trajectory file mapped into memory. Frames are decoded straight from the mapping, nothing is loaded
+// up front, so opening a file of several hours costs the same as opening a short one: Open only checks
+// the header and the block table, and each block is checked when a cursor gets to it. A frame in a
+// damaged block sets the cursor's Damaged flag and gives the cursor's last pose instead.
+class CameraTrajectory
+{
+public:
+    CameraTrajectory() : data(NULL), size(0), header(NULL) {}
+
+    ~CameraTrajectory() {
+        Close();
+    }
+
+    bool Open(const char *path)
+    {
+        Close();
+        if(!file.Open(path))
+            return false;
+        data = file.Data();
+        size = file.Size();
+        if(!validate()){
+            Close();
+            return false;
+        }
+        header = (const trajectoryHeader *)data;
+        return true;
+    }
+
+    void Close()
+    {
+        file.Close();
+        data = NULL;
+        size = 0;
+        header = NULL;
+    }
+
+    bool IsOpen() const {
+        return header != NULL;
+    }
+
+    unsigned int Frames() const {
+        return header ? header->Frames : 0;
+    }
+
+    float SampleRate() const {
+        return header ? header->SampleRate : 0;
+    }
+
+    // Time of the last frame, in seconds
+    float Duration() const {
+        return Frames() > 1 ? (Frames() - 1) / header->SampleRate : 0;
+    }
+
+    // Pose of one frame, moving the cursor there
+    trajectoryPose Frame(unsigned int frame, trajectoryCursor &cursor) const
+    {
+        if(!seek(frame, cursor))
+            return current(cursor);
+        float v[TRAJECTORY_VALUES];
+        for(unsigned int i = 0; i < TRAJECTORY_VALUES; i++)
+            v[i] = (float)cursor.Values[i];
+        return decode(v, block(cursor.Block));
+    }
+
+    trajectoryPose Frame(unsigned int frame) const
+    {
+        trajectoryCursor cursor;
+        return Frame(frame, cursor);
+    }
+
+    // Pose at a time in seconds from the first frame, blended between the two closest frames.
+    // Times outside the recording give the first or last frame
+    trajectoryPose Sample(float time, trajectoryCursor &cursor) const
+    {
+        float f = time * header->SampleRate;
+        if(!(f > 0))
+            return Frame(0, cursor);
+        if(f >= header->Frames - 1)
+            return Frame(header->Frames - 1, cursor);
+
+        unsigned int frame = (unsigned int)f;
+        float t = f - frame;
+        if(!seek(frame, cursor))
+            return current(cursor);
+        const trajectoryBlock *b = block(cursor.Block);
+
+        // the next frame is decoded on the side, so the cursor stays on frame and the next call moves on from there
+        int32_t next[TRAJECTORY_VALUES];
+        if(frame + 1 < b->FirstFrame + b->Frames){
+            memcpy(next, cursor.Values, sizeof(next));
+            apply(deltas(b) + (frame - b->FirstFrame), next);
+        }
+        else if(cursor.Block + 1 < header->Blocks && intact(cursor.Block + 1, frame + 1))
+            load(block(cursor.Block + 1), next);
+        else {
+            cursor.Damaged = true;
+            return current(cursor);
+        }
+
+        // the quantized values are blended, so there is one pose to decode and one quaternion to normalize
+        float v[TRAJECTORY_VALUES];
+        for(unsigned int i = 0; i < TRAJECTORY_VALUES; i++)
+            v[i] = cursor.Values[i] + t * (float)(next[i] - cursor.Values[i]);
+        return decode(v, b);
+    }
+
+private:
+    MappedFile file;
+    const unsigned char *data;
+    size_t size;
+    const trajectoryHeader *header;
+
+    CameraTrajectory(const CameraTrajectory &);
+    CameraTrajectory &operator=(const CameraTrajectory &);
+
+    const trajectoryBlock *block(unsigned int b) const
+    {
+        uint64_t offset;
+        memcpy(&offset, data + header->BlockTable + b * sizeof(uint64_t), sizeof(offset));
+        return (const trajectoryBlock *)(data + offset);
+    }
+
+    const trajectoryDelta *deltas(const trajectoryBlock *b) const
+    {
+        return (const trajectoryDelta *)(b + 1);
+    }
+
+    // Block holding a frame, by binary search on the first frames
+    unsigned int findBlock(unsigned int frame) const
+    {
+        unsigned int lo = 0, hi = header->Blocks - 1;
+        while(lo < hi){
+            unsigned int mid = (lo + hi + 1) / 2;
+            if(block(mid)->FirstFrame <= frame)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        return lo;
+    }
+
+    // Moves the cursor to a frame. Returns false, leaving the cursor where it was, if the frame's block is damaged
+    bool seek(unsigned int frame, trajectoryCursor &cursor) const
+    {
+        if(frame >= header->Frames)
+            frame = header->Frames - 1;
+
+        const trajectoryBlock *b = cursor.Valid ? block(cursor.Block) : NULL;
+        if(!b || frame < cursor.Frame || frame >= b->FirstFrame + b->Frames){
+            // the next block is the usual case during playback
+            unsigned int next;
+            if(b && frame >= cursor.Frame && cursor.Block + 1 < header->Blocks && frame < block(cursor.Block + 1)->FirstFrame + block(cursor.Block + 1)->Frames)
+                next = cursor.Block + 1;
+            else
+                next = findBlock(frame);
+            if(!intact(next, frame)){
+                cursor.Damaged = true;
+                return false;
+            }
+            cursor.Block = next;
+            b = block(cursor.Block);
+            cursor.Frame = b->FirstFrame;
+            load(b, cursor.Values);
+            cursor.Valid = true;
+        }
+
+        const trajectoryDelta *d = deltas(b) + (cursor.Frame - b->FirstFrame);
+        for(; cursor.Frame < frame; cursor.Frame++, d++)
+            apply(d, cursor.Values);
+        return true;
+    }
+
+    // Whether block b holds frame and all of its deltas are inside the file. Open only checked that the
+    // block's header is
+    bool intact(unsigned int b, unsigned int frame) const
+    {
+        uint64_t offset;
+        memcpy(&offset, data + header->BlockTable + b * sizeof(uint64_t), sizeof(offset));
+        const trajectoryBlock *k = (const trajectoryBlock *)(data + offset);
+        if(k->Frames == 0 || k->Frames > TRAJECTORY_BLOCK_FRAMES || frame < k->FirstFrame || frame - k->FirstFrame >= k->Frames)
+            return false;
+        return size - offset - sizeof(trajectoryBlock) >= (k->Frames - 1) * (uint64_t)sizeof(trajectoryDelta);
+    }
+
+    // Pose the cursor is on, for frames that can't be decoded; a camera's default one if it isn't on any yet
+    trajectoryPose current(const trajectoryCursor &cursor) const
+    {
+        if(!cursor.Valid)
+            return DefaultTrajectoryPose();
+        float v[TRAJECTORY_VALUES];
+        for(unsigned int i = 0; i < TRAJECTORY_VALUES; i++)
+            v[i] = (float)cursor.Values[i];
+        return decode(v, block(cursor.Block));
+    }
+
+    static void load(const trajectoryBlock *b, int32_t *v)
+    {
+        for(int i = 0; i < 3; i++)
+            v[i] = b->Position[i];
+        for(int i = 0; i < 4; i++)
+            v[3 + i] = b->Orientation[i];
+        v[7] = b->Zoom;
+    }
+
+    static void apply(const trajectoryDelta *d, int32_t *v)
+    {
+        for(int i = 0; i < 3; i++)
+            v[i] += d->Position[i];
+        for(int i = 0; i < 4; i++)
+            v[3 + i] += d->Orientation[i];
+        v[7] += d->Zoom;
+    }
+
+    trajectoryPose decode(const float *v, const trajectoryBlock *b) const
+    {
+        trajectoryPose p;
+        p.Position = glm::vec3(v[0], v[1], v[2]) * header->PositionStep;
+        p.Orientation = glm::normalize(glm::quat(v[3], v[4], v[5], v[6]));
+        p.Zoom = v[7] * TRAJECTORY_ZOOM_STEP;
+        p.Near = b->Near;
+        p.Far = b->Far;
+        return p;
+    }
+
+    // Checks the header and that the block table and every block header it points to lie inside the file.
+    // The blocks themselves aren't read: see intact
+    bool validate() const
+    {
+        if(size < sizeof(trajectoryHeader))
+            return false;
+        const trajectoryHeader *h = (const trajectoryHeader *)data;
+        if(memcmp(h->Magic, "CTRJ", 4) != 0 || h->Version != TRAJECTORY_VERSION || !(h->SampleRate > 0) || !(h->PositionStep > 0))
+            return false;
+        if(h->Frames == 0 || h->Blocks == 0 || h->Blocks > h->Frames || h->BlockTable > size || (size - h->BlockTable) / sizeof(uint64_t) < h->Blocks)
+            return false;
+
+        for(uint32_t i = 0; i < h->Blocks; i++){
+            uint64_t offset;
+            memcpy(&offset, data + h->BlockTable + i * sizeof(uint64_t), sizeof(offset));
+            if(offset % 4 != 0 || offset < sizeof(trajectoryHeader) || offset > size || size - offset < sizeof(trajectoryBlock))
+                return false;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,168 @@
+#ifndef CURVE_KERNELS_H
+#define CURVE_KERNELS_H
+
+#include <glm/glm.hpp>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Batch evaluation of cubic curves into contiguous float arrays, one array per component.
+// Every cubic is written in power form c0 + c1 t + c2 t^2 + c3 t^3 and evaluated with Horner's rule,
+// 4 (SSE) or 8 (AVX) values at a time; the scalar functions are the reference the SIMD ones must match.
+// Compile with -mavx (or /arch:AVX) to get the 8 wide kernels, SSE2 is used otherwise on x86-64.
+
+// Rows convert the control points (p0, p1, p2, p3) into the power coefficients (c0, c1, c2, c3)
+struct CubicBasis {
+    float m[4][4];
+};
+
+// Same curve as Camera::Bezier
+const CubicBasis BEZIER_BASIS = {{
+    {  1.0f,  0.0f,  0.0f, 0.0f },
+    { -3.0f,  3.0f,  0.0f, 0.0f },
+    {  3.0f, -6.0f,  3.0f, 0.0f },
+    { -1.0f,  3.0f, -3.0f, 1.0f }
+}};
+
+// Same curve as glm::catmullRom(p0, p1, p2, p3, t)
+const CubicBasis CATMULL_ROM_BASIS = {{
+    {  0.0f,  1.0f,  0.0f,  0.0f },
+    { -0.5f,  0.0f,  0.5f,  0.0f },
+    {  1.0f, -2.5f,  2.0f, -0.5f },
+    { -0.5f,  1.5f, -1.5f,  0.5f }
+}};
+
+// Power coefficients of one component of a curve
+inline glm::vec4 CubicCoefficients(const CubicBasis &basis, float p0, float p1, float p2, float p3)
+{
+    glm::vec4 c;
+    for(int k = 0; k < 4; k++)
+        c[k] = basis.m[k][0] * p0 + basis.m[k][1] * p1 + basis.m[k][2] * p2 + basis.m[k][3] * p3;
+    return c;
+}
+
+// ------------------------------------------------------------------------------------------------
+// One curve, many parameter values: out[i] = curve(t[i]) for one component
+// ------------------------------------------------------------------------------------------------
+
+inline void CubicSamplesScalar(glm::vec4 c, const float *t, float *out, unsigned int count)
+{
+    for(unsigned int i = 0; i < count; i++)
+        out[i] = c[0] + t[i] * (c[1] + t[i] * (c[2] + t[i] * c[3]));
+}
+
+inline void CubicSamples(glm::vec4 c, const float *t, float *out, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(__AVX__)
+    __m256 c0 = _mm256_set1_ps(c[0]), c1 = _mm256_set1_ps(c[1]), c2 = _mm256_set1_ps(c[2]), c3 = _mm256_set1_ps(c[3]);
+    for(; i + 8 <= count; i += 8){
+        __m256 x = _mm256_loadu_ps(t + i);
+        __m256 v = _mm256_add_ps(c2, _mm256_mul_ps(x, c3));
+        v = _mm256_add_ps(c1, _mm256_mul_ps(x, v));
+        v = _mm256_add_ps(c0, _mm256_mul_ps(x, v));
+        _mm256_storeu_ps(out + i, v);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 c0 = _mm_set1_ps(c[0]), c1 = _mm_set1_ps(c[1]), c2 = _mm_set1_ps(c[2]), c3 = _mm_set1_ps(c[3]);
+    for(; i + 4 <= count; i += 4){
+        __m128 x = _mm_loadu_ps(t + i);
+        __m128 v = _mm_add_ps(c2, _mm_mul_ps(x, c3));
+        v = _mm_add_ps(c1, _mm_mul_ps(x, v));
+        v = _mm_add_ps(c0, _mm_mul_ps(x, v));
+        _mm_storeu_ps(out + i, v);
+    }
+#endif
+    CubicSamplesScalar(c, t + i, out + i, count - i);
+}
+
+// count points at t = 0, 1/(count-1), ..., 1 by forward differencing: three additions per point.
+// Accumulates rounding error over very long runs, so use CubicSamples when count is in the millions.
+inline void CubicUniform(glm::vec4 c, float *out, unsigned int count)
+{
+    if(count == 0)
+        return;
+    if(count == 1){
+        out[0] = c[0];
+        return;
+    }
+
+    float h = 1.0f / (count - 1);
+    float v = c[0];
+    float d1 = c[1] * h + c[2] * h * h + c[3] * h * h * h;
+    float d2 = 2 * c[2] * h * h + 6 * c[3] * h * h * h;
+    float d3 = 6 * c[3] * h * h * h;
+    for(unsigned int i = 0; i < count; i++){
+        out[i] = v;
+        v += d1;
+        d1 += d2;
+        d2 += d3;
+    }
+}
+
+// Samples a whole curve into three component arrays
+inline void CurveSamples(const CubicBasis &basis, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3,
+                         const float *t, float *outX, float *outY, float *outZ, unsigned int count)
+{
+    CubicSamples(CubicCoefficients(basis, P0.x, P1.x, P2.x, P3.x), t, outX, count);
+    CubicSamples(CubicCoefficients(basis, P0.y, P1.y, P2.y, P3.y), t, outY, count);
+    CubicSamples(CubicCoefficients(basis, P0.z, P1.z, P2.z, P3.z), t, outZ, count);
+}
+
+inline void CurveUniform(const CubicBasis &basis, glm::vec3 P0, glm::vec3 P1, glm::vec3 P2, glm::vec3 P3,
+                         float *outX, float *outY, float *outZ, unsigned int count)
+{
+    CubicUniform(CubicCoefficients(basis, P0.x, P1.x, P2.x, P3.x), outX, count);
+    CubicUniform(CubicCoefficients(basis, P0.y, P1.y, P2.y, P3.y), outY, count);
+    CubicUniform(CubicCoefficients(basis, P0.z, P1.z, P2.z, P3.z), outZ, count);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Many curves, one parameter value each: out[i] = curve_i(t[i]) for one component,
+// with the control points of curve i at p0[i], p1[i], p2[i], p3[i] (e.g. one curve per camera)
+// ------------------------------------------------------------------------------------------------
+
+inline void CubicBatchScalar(const CubicBasis &basis, const float *p0, const float *p1, const float *p2, const float *p3,
+                             const float *t, float *out, unsigned int count)
+{
+    for(unsigned int i = 0; i < count; i++){
+        glm::vec4 c = CubicCoefficients(basis, p0[i], p1[i], p2[i], p3[i]);
+        out[i] = c[0] + t[i] * (c[1] + t[i] * (c[2] + t[i] * c[3]));
+    }
+}
+
+inline void CubicBatch(const CubicBasis &basis, const float *p0, const float *p1, const float *p2, const float *p3,
+                       const float *t, float *out, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(__AVX__)
+    for(; i + 8 <= count; i += 8){
+        __m256 a = _mm256_loadu_ps(p0 + i), b = _mm256_loadu_ps(p1 + i), c = _mm256_loadu_ps(p2 + i), d = _mm256_loadu_ps(p3 + i);
+        __m256 x = _mm256_loadu_ps(t + i);
+        __m256 v = _mm256_setzero_ps();
+        for(int k = 3; k >= 0; k--){
+            __m256 ck = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(basis.m[k][0]), a), _mm256_mul_ps(_mm256_set1_ps(basis.m[k][1]), b)),
+                                      _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(basis.m[k][2]), c), _mm256_mul_ps(_mm256_set1_ps(basis.m[k][3]), d)));
+            v = _mm256_add_ps(ck, _mm256_mul_ps(x, v));
+        }
+        _mm256_storeu_ps(out + i, v);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    for(; i + 4 <= count; i += 4){
+        __m128 a = _mm_loadu_ps(p0 + i), b = _mm_loadu_ps(p1 + i), c = _mm_loadu_ps(p2 + i), d = _mm_loadu_ps(p3 + i);
+        __m128 x = _mm_loadu_ps(t + i);
+        __m128 v = _mm_setzero_ps();
+        for(int k = 3; k >= 0; k--){
+            __m128 ck = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(basis.m[k][0]), a), _mm_mul_ps(_mm_set1_ps(basis.m[k][1]), b)),
+                                   _mm_add_ps(_mm_mul_ps(_mm_set1_ps(basis.m[k][2]), c), _mm_mul_ps(_mm_set1_ps(basis.m[k][3]), d)));
+            v = _mm_add_ps(ck, _mm_mul_ps(x, v));
+        }
+        _mm_storeu_ps(out + i, v);
+    }
+#endif
+    CubicBatchScalar(basis, p0 + i, p1 + i, p2 + i, p3 + i, t + i, out + i, count - i);
+}
+#endif
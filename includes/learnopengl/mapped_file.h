@@ -0,0 +1,93 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A read-only file mapped into memory, so its contents are paged in as they are read and nothing
+// is loaded up front. Without mmap (Windows) the file is read into memory instead.
+class MappedFile
+{
+public:
+    MappedFile() : data(NULL), size(0) {}
+
+    ~MappedFile() {
+        Close();
+    }
+
+    bool Open(const char *path)
+    {
+        Close();
+#ifndef _WIN32
+        int fd = open(path, O_RDONLY);
+        if(fd < 0)
+            return false;
+        struct stat st;
+        if(fstat(fd, &st) == 0 && st.st_size > 0){
+            void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if(mapping != MAP_FAILED){
+                data = (const unsigned char *)mapping;
+                size = (size_t)st.st_size;
+            }
+        }
+        close(fd);
+#else
+        FILE *file = fopen(path, "rb");
+        if(!file)
+            return false;
+        unsigned char chunk[65536];
+        size_t read;
+        while((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+            buffer.insert(buffer.end(), chunk, chunk + read);
+        fclose(file);
+        if(!buffer.empty()){
+            data = &buffer[0];
+            size = buffer.size();
+        }
+#endif
+        return data != NULL;
+    }
+
+    void Close()
+    {
+#ifndef _WIN32
+        if(data)
+            munmap((void *)data, size);
+#else
+        std::vector<unsigned char>().swap(buffer);
+#endif
+        data = NULL;
+        size = 0;
+    }
+
+    bool IsOpen() const {
+        return data != NULL;
+    }
+
+    const unsigned char *Data() const {
+        return data;
+    }
+
+    size_t Size() const {
+        return size;
+    }
+
+private:
+    const unsigned char *data;
+    size_t size;
+#ifdef _WIN32
+    std::vector<unsigned char> buffer;
+#endif
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+};
+#endif
@@ -0,0 +1,51 @@
+#ifndef MESH_GEOMETRY_H
+#define MESH_GEOMETRY_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// CPU-side views of the triangles of a scene, for passes that don't go through OpenGL: the visibility
+// bake (path_visibility.h) and camera collision (camera_collision.h). Nothing is copied, so the models
+// must outlive them.
+
+// Triangles of a mesh, read in place from its vertex array
+struct occluderMesh {
+    const float *Positions;     // x, y, z of the first vertex
+    unsigned int Stride;        // bytes from one vertex to the next
+    unsigned int Vertices;
+    const unsigned int *Indices;
+    unsigned int IndexCount;
+};
+
+// Position of vertex i
+inline glm::vec3 OccluderVertex(const occluderMesh &m, unsigned int i)
+{
+    const float *p = (const float *)((const char *)m.Positions + (size_t)i * m.Stride);
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+struct occluderModel {
+    glm::mat4 Transform;        // model matrix
+    std::vector<occluderMesh> Meshes;
+};
+
+// The meshes of a Model (or anything with the same meshes / vertices / indices layout), placed by its model matrix
+template <typename M>
+inline occluderModel OccluderFromModel(const M &model, const glm::mat4 &transform)
+{
+    occluderModel o;
+    o.Transform = transform;
+    for(unsigned int i = 0; i < model.meshes.size(); i++){
+        occluderMesh m;
+        m.Vertices = (unsigned int)model.meshes[i].vertices.size();
+        m.Positions = m.Vertices ? &model.meshes[i].vertices[0].Position.x : NULL;
+        m.Stride = sizeof(model.meshes[i].vertices[0]);
+        m.IndexCount = (unsigned int)model.meshes[i].indices.size();
+        m.Indices = m.IndexCount ? &model.meshes[i].indices[0] : NULL;
+        o.Meshes.push_back(m);
+    }
+    return o;
+}
+#endif
@@ -21,7 +21,17 @@
 #include <vector>
 using namespace std;
 
+// an image read and decoded from disk, not yet handed to OpenGL
+struct DecodedImage {
+    string path;
+    string type;
+    unsigned char *data;
+    int width, height, nrComponents;
+};
+
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
+DecodedImage DecodeImage(const char *path, const string &directory);
+unsigned int TextureFromImage(const DecodedImage &image);
 
 class Model 
 {
@@ -34,11 +44,47 @@ public:
 
     /*  Functions   */
     // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+    // a deferred model only remembers the path: Decode reads the files (on any thread, no OpenGL calls)
+    // and Upload creates the buffers and textures (on the OpenGL thread), e.g. from an AssetPrefetcher
+    Model(string const &path, bool gamma = false, bool deferred = false) : gammaCorrection(gamma), path(path)
+    {
+        if(!deferred)
+        {
+            Decode();
+            Upload();
+        }
+    }
+
+    // reads the model file and decodes its textures
+    void Decode()
     {
         loadModel(path);
     }
 
+    // hands the decoded meshes and textures to OpenGL and frees the decoded data
+    void Upload()
+    {
+        size_t first = textures_loaded.size();
+        for(unsigned int i = 0; i < images.size(); i++)
+        {
+            Texture texture;
+            texture.id = TextureFromImage(images[i]);
+            texture.type = images[i].type;
+            texture.path = images[i].path;
+            textures_loaded.push_back(texture);
+            stbi_image_free(images[i].data);
+        }
+        for(unsigned int i = 0; i < decodedMeshes.size(); i++)
+        {
+            vector<Texture> textures;
+            for(unsigned int j = 0; j < decodedMeshes[i].textures.size(); j++)
+                textures.push_back(textures_loaded[first + decodedMeshes[i].textures[j]]);
+            meshes.push_back(Mesh(decodedMeshes[i].vertices, decodedMeshes[i].indices, textures));
+        }
+        images.clear();
+        decodedMeshes.clear();
+    }
+
     // draws the model, and thus all its meshes
     void Draw(Shader shader)
     {
@@ -47,6 +93,17 @@ public:
     }
     
 private:
+    // a mesh read from the file, with its textures as indices into images
+    struct DecodedMesh {
+        vector<Vertex> vertices;
+        vector<unsigned int> indices;
+        vector<unsigned int> textures;
+    };
+
+    string path;
+    vector<DecodedImage> images;
+    vector<DecodedMesh> decodedMeshes;
+
     /*  Functions   */
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const &path)
@@ -76,7 +133,7 @@ private:
             // the node object only contains indices to index the actual objects in the scene. 
             // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+            decodedMeshes.push_back(processMesh(mesh, scene));
         }
         // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
         for(unsigned int i = 0; i < node->mNumChildren; i++)
@@ -86,12 +143,13 @@ private:
 
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    DecodedMesh processMesh(aiMesh *mesh, const aiScene *scene)
     {
         // data to fill
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
+        DecodedMesh decoded;
+        vector<Vertex> &vertices = decoded.vertices;
+        vector<unsigned int> &indices = decoded.indices;
+        vector<unsigned int> &textures = decoded.textures;
 
         // Walk through each of the mesh's vertices
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -150,92 +208,97 @@ private:
         // normal: texture_normalN
 
         // 1. diffuse maps
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", textures);
         // 2. specular maps
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", textures);
         // 3. normal maps
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", textures);
         // 4. height maps
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+        loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", textures);
         
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        // return the extracted mesh data, Upload makes a mesh object from it
+        return decoded;
     }
 
-    // checks all material textures of a given type and loads the textures if they're not loaded yet.
-    // the required info is returned as a Texture struct.
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+    // checks all material textures of a given type and decodes the textures if they're not decoded yet.
+    // the textures are added as indices into images.
+    void loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName, vector<unsigned int> &textures)
     {
-        vector<Texture> textures;
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
         {
             aiString str;
             mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
+            // check if texture was decoded before and if so, continue to next iteration: skip decoding a new texture
             bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
+            for(unsigned int j = 0; j < images.size(); j++)
             {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
+                if(std::strcmp(images[j].path.data(), str.C_Str()) == 0)
                 {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
+                    textures.push_back(j);
+                    skip = true; // a texture with the same filepath has already been decoded, continue to next one. (optimization)
                     break;
                 }
             }
             if(!skip)
-            {   // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
+            {   // if texture hasn't been decoded already, decode it
+                DecodedImage image = DecodeImage(str.C_Str(), this->directory);
+                image.type = typeName;
+                image.path = str.C_Str();
+                textures.push_back((unsigned int)images.size());
+                images.push_back(image);  // store it as texture decoded for entire model, to ensure we won't unnecesery decode duplicate textures.
             }
         }
-        return textures;
     }
 };
 
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
+{
+    DecodedImage image = DecodeImage(path, directory);
+    unsigned int textureID = TextureFromImage(image);
+    stbi_image_free(image.data);
+    return textureID;
+}
+
+// reads and decodes an image, without any OpenGL call, so it can run on any thread.
+// data is NULL if the image couldn't be loaded; free it with stbi_image_free
+DecodedImage DecodeImage(const char *path, const string &directory)
 {
     string filename = string(path);
     filename = directory + '/' + filename;
 
+    DecodedImage image;
+    image.path = path;
+    image.data = stbi_load(filename.c_str(), &image.width, &image.height, &image.nrComponents, 0);
+    if (!image.data)
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+    return image;
+}
+
+// creates a texture from a decoded image (an empty one if the image couldn't be loaded)
+unsigned int TextureFromImage(const DecodedImage &image)
+{
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
+    if (image.data)
     {
         GLenum format;
-        if (nrComponents == 1)
+        if (image.nrComponents == 1)
             format = GL_RED;
-        else if (nrComponents == 3)
+        else if (image.nrComponents == 3)
             format = GL_RGB;
-        else if (nrComponents == 4)
+        else if (image.nrComponents == 4)
             format = GL_RGBA;
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
     }
 
     return textureID;
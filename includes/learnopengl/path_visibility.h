@@ -0,0 +1,449 @@
+#ifndef PATH_VISIBILITY_H
+#define PATH_VISIBILITY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/mesh_geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// Potentially visible sets baked along a camera path. The bake splits a Bezier or B-spline path in
+// segments, looks all around from points along each one and keeps, per segment, one bit per mesh of the
+// scene telling whether the mesh can be seen from anywhere on it. Drawing a segment's set instead of the
+// whole scene skips the meshes hidden behind others or too far away. The sets hold whatever direction
+// the camera looks in, but only for positions on the path.
+//
+// Visibility files are a visibilityHeader, the number of meshes of each model (uint32_t), then Words
+// uint32_t of bits per segment, mesh i of the scene in bit i % 32 of word i / 32. All little-endian.
+
+const uint32_t VISIBILITY_VERSION = 1;
+
+struct visibilityHeader {
+    char Magic[4];              // "CPVS"
+    uint32_t Version;
+    uint32_t Layer;             // LAYER_BEZIER or LAYER_BSPLINE
+    float Points[12];           // control points of the path
+    uint32_t Segments;
+    uint32_t Models;
+};
+
+// Software depth buffer for the bake: triangles are rasterized at pixel centers, keeping the largest
+// 1 / w (the nearest surface) per pixel, and boxes are tested against it conservatively
+class occlusionBuffer
+{
+public:
+    occlusionBuffer(unsigned int resolution) : size(resolution), depth(resolution * resolution, 0.0f) {}
+
+    void Clear() {
+        std::fill(depth.begin(), depth.end(), 0.0f);
+    }
+
+    // A triangle in clip space, clipped against the near plane
+    void DrawTriangle(glm::vec4 a, glm::vec4 b, glm::vec4 c)
+    {
+        glm::vec4 in[3] = { a, b, c };
+        glm::vec4 out[4];
+        unsigned int n = 0;
+        for(unsigned int i = 0; i < 3; i++){
+            const glm::vec4 &p = in[i], &q = in[(i + 1) % 3];
+            float dp = p.z + p.w, dq = q.z + q.w;
+            if(dp >= 0)
+                out[n++] = p;
+            if((dp >= 0) != (dq >= 0))
+                out[n++] = p + (dp / (dp - dq)) * (q - p);
+        }
+        for(unsigned int i = 2; i < n; i++)
+            rasterize(out[0], out[i - 1], out[i]);
+    }
+
+    // Keeps, in every pixel, the farthest depth of it and its eight neighbours: rasterizing at pixel
+    // centers covers the pixels a gap only partly crosses, this opens them again. Call it after drawing,
+    // before testing boxes
+    void Erode()
+    {
+        eroded.resize(depth.size());
+        for(unsigned int y = 0; y < size; y++)
+            for(unsigned int x = 0; x < size; x++){
+                float d = depth[y * size + x];
+                for(unsigned int j = y ? y - 1 : 0; j <= y + 1 && j < size; j++)
+                    for(unsigned int i = x ? x - 1 : 0; i <= x + 1 && i < size; i++)
+                        d = std::min(d, depth[j * size + i]);
+                eroded[y * size + x] = d;
+            }
+        depth.swap(eroded);
+    }
+
+    // Whether any part of a box, given by its eight corners in clip space, can be in front of what was
+    // drawn. Boxes reaching behind the near plane always can
+    bool BoxVisible(const glm::vec4 *corners) const
+    {
+        float x0 = (float)size, y0 = (float)size, x1 = 0, y1 = 0, nearest = 0;
+        for(unsigned int i = 0; i < 8; i++){
+            const glm::vec4 &p = corners[i];
+            if(p.z < -p.w || p.w <= 0)
+                return true;
+            float invW = 1.0f / p.w;
+            glm::vec2 s = screen(p, invW);
+            x0 = std::min(x0, s.x);
+            y0 = std::min(y0, s.y);
+            x1 = std::max(x1, s.x);
+            y1 = std::max(y1, s.y);
+            nearest = std::max(nearest, invW);
+        }
+
+        // one pixel of margin for the pixels the box only partly covers
+        int left = std::max((int)std::floor(x0) - 1, 0), bottom = std::max((int)std::floor(y0) - 1, 0);
+        int right = std::min((int)std::ceil(x1) + 1, (int)size - 1), top = std::min((int)std::ceil(y1) + 1, (int)size - 1);
+        nearest *= 1.0001f;
+        for(int y = bottom; y <= top; y++)
+            for(int x = left; x <= right; x++)
+                if(depth[y * size + x] <= nearest)
+                    return true;
+        return false;
+    }
+
+private:
+    unsigned int size;
+    std::vector<float> depth;
+    std::vector<float> eroded;
+
+    glm::vec2 screen(const glm::vec4 &p, float invW) const {
+        return glm::vec2((p.x * invW * 0.5f + 0.5f) * size, (p.y * invW * 0.5f + 0.5f) * size);
+    }
+
+    void rasterize(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+    {
+        float wa = 1.0f / a.w, wb = 1.0f / b.w, wc = 1.0f / c.w;
+        glm::vec2 pa = screen(a, wa), pb = screen(b, wb), pc = screen(c, wc);
+        float area = (pb.x - pa.x) * (pc.y - pa.y) - (pb.y - pa.y) * (pc.x - pa.x);
+        if(area == 0 || area != area)
+            return;
+
+        int left = std::max((int)std::floor(std::min(pa.x, std::min(pb.x, pc.x))), 0);
+        int right = std::min((int)std::ceil(std::max(pa.x, std::max(pb.x, pc.x))), (int)size - 1);
+        int bottom = std::max((int)std::floor(std::min(pa.y, std::min(pb.y, pc.y))), 0);
+        int top = std::min((int)std::ceil(std::max(pa.y, std::max(pb.y, pc.y))), (int)size - 1);
+
+        // 1 / w is linear in screen space, so it is interpolated with the screen barycentrics
+        float inv = 1.0f / area;
+        for(int y = bottom; y <= top; y++)
+            for(int x = left; x <= right; x++){
+                glm::vec2 p((float)x + 0.5f, (float)y + 0.5f);
+                float ea = ((pc.x - pb.x) * (p.y - pb.y) - (pc.y - pb.y) * (p.x - pb.x)) * inv;
+                float eb = ((pa.x - pc.x) * (p.y - pc.y) - (pa.y - pc.y) * (p.x - pc.x)) * inv;
+                float ec = 1.0f - ea - eb;
+                if(ea < 0 || eb < 0 || ec < 0)
+                    continue;
+                float d = ea * wa + eb * wb + ec * wc;
+                float &pixel = depth[y * size + x];
+                if(d > pixel)
+                    pixel = d;
+            }
+    }
+};
+
+class PathVisibility
+{
+public:
+    CameraLayer Layer;              // LAYER_BEZIER or LAYER_BSPLINE
+    glm::vec3 Points[4];            // the path's control points
+    unsigned int Segments;
+    std::vector<unsigned int> FirstMesh;    // bit of each model's first mesh, then the number of meshes
+    unsigned int Words;             // bit words per segment
+    std::vector<uint32_t> Bits;
+
+    PathVisibility() : Layer(LAYER_BEZIER), Segments(0), Words(0) {}
+
+    unsigned int Models() const {
+        return FirstMesh.empty() ? 0 : (unsigned int)FirstMesh.size() - 1;
+    }
+
+    unsigned int Meshes(unsigned int model) const {
+        return FirstMesh[model + 1] - FirstMesh[model];
+    }
+
+    bool Visible(unsigned int segment, unsigned int model, unsigned int mesh) const {
+        unsigned int bit = FirstMesh[model] + mesh;
+        return (Bits[segment * Words + bit / 32] >> (bit % 32)) & 1;
+    }
+
+    // Meshes of the whole scene visible from a segment
+    unsigned int VisibleCount(unsigned int segment) const
+    {
+        unsigned int count = 0;
+        for(unsigned int i = 0; i < Words; i++)
+            for(uint32_t w = Bits[segment * Words + i]; w; w &= w - 1)
+                count++;
+        return count;
+    }
+
+    // Segment the camera is on, or -1 if it isn't playing this path
+    int Segment(const Camera &camera) const
+    {
+        spline curve;
+        float fraction;
+        if(Segments == 0 || !camera.runningCurve(Layer, curve, fraction))
+            return -1;
+        if(curve.p0 != Points[0] || curve.p1 != Points[1] || curve.p2 != Points[2] || curve.p3 != Points[3])
+            return -1;
+        return std::min((int)(fraction * Segments), (int)Segments - 1);
+    }
+
+    // Bakes the sets of the path the camera takes with bezierPath (LAYER_BEZIER) or bSplinePath
+    // (LAYER_BSPLINE) from p0 to p3. Each segment is looked at from samples points along it, ends
+    // included, in all six directions at resolution x resolution pixels. Meshes beyond far, or behind
+    // other meshes from every point, are left out. What is only seen between two points, or through gaps
+    // narrower than a pixel, can be missed: raise samples or resolution for scenes with thin gaps.
+    // threads = 0 uses every hardware thread
+    static PathVisibility Bake(CameraLayer layer, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, const std::vector<occluderModel> &models,
+                               unsigned int segments = 32, unsigned int samples = 4, unsigned int resolution = 128, float far = FAR, unsigned int threads = 0)
+    {
+        PathVisibility v;
+        v.Layer = layer;
+        v.Points[0] = p0;
+        v.Points[1] = p1;
+        v.Points[2] = p2;
+        v.Points[3] = p3;
+        v.Segments = std::max(segments, 1u);
+        v.FirstMesh.push_back(0);
+        for(unsigned int m = 0; m < models.size(); m++)
+            v.FirstMesh.push_back(v.FirstMesh.back() + (unsigned int)models[m].Meshes.size());
+        v.Words = (v.FirstMesh.back() + 31) / 32;
+        v.Bits.assign(v.Segments * v.Words, 0);
+
+        bakeScene scene;
+        scene.Models = &models;
+        scene.Far = far;
+        scene.Resolution = std::max(resolution, 8u);
+        for(unsigned int m = 0; m < models.size(); m++)
+            for(unsigned int i = 0; i < models[m].Meshes.size(); i++)
+                scene.Boxes.push_back(worldBox(models[m].Transform, models[m].Meshes[i]));
+
+        // the camera's own code places the points, so they are where playback will take it. Neighbour
+        // segments share their end points
+        unsigned int steps = std::max(samples, 2u) - 1;
+        unsigned int points = v.Segments * steps + 1;
+        Camera camera(p0);
+        if(layer == LAYER_BSPLINE)
+            camera.bSplinePath(p0, p1, p2, p3, 1.0f);
+        else
+            camera.bezierPath(p0, p1, p2, p3, 1.0f);
+        for(unsigned int i = 0; i < points; i++){
+            camera.evaluateAt(std::min(i / (float)(points - 1), 0.99999f));
+            scene.Points.push_back(camera.Position);
+        }
+
+        std::vector< std::vector<uint32_t> > seen(points, std::vector<uint32_t>(v.Words, 0));
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, points);
+        std::vector<std::thread> workers;
+        for(unsigned int t = 1; t < threads; t++)
+            workers.push_back(std::thread(&PathVisibility::bakePoints, &scene, &seen, t, threads));
+        bakePoints(&scene, &seen, 0, threads);
+        for(unsigned int i = 0; i < workers.size(); i++)
+            workers[i].join();
+
+        for(unsigned int s = 0; s < v.Segments; s++)
+            for(unsigned int i = s * steps; i <= (s + 1) * steps; i++)
+                for(unsigned int w = 0; w < v.Words; w++)
+                    v.Bits[s * v.Words + w] |= seen[i][w];
+        return v;
+    }
+
+    bool Save(const char *path) const
+    {
+        FILE *file = fopen(path, "wb");
+        if(!file)
+            return false;
+
+        visibilityHeader header;
+        memcpy(header.Magic, "CPVS", 4);
+        header.Version = VISIBILITY_VERSION;
+        header.Layer = Layer;
+        for(unsigned int i = 0; i < 4; i++)
+            for(unsigned int j = 0; j < 3; j++)
+                header.Points[3 * i + j] = Points[i][j];
+        header.Segments = Segments;
+        header.Models = Models();
+
+        std::vector<uint32_t> counts;
+        for(unsigned int m = 0; m < Models(); m++)
+            counts.push_back(Meshes(m));
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && (counts.empty() || fwrite(&counts[0], sizeof(uint32_t), counts.size(), file) == counts.size());
+        ok = ok && (Bits.empty() || fwrite(&Bits[0], sizeof(uint32_t), Bits.size(), file) == Bits.size());
+        return fclose(file) == 0 && ok;
+    }
+
+    // Leaves the sets unchanged if the file can't be read or isn't a visibility file
+    bool Load(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if(!file)
+            return false;
+
+        visibilityHeader header;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.Magic, "CPVS", 4) == 0 && header.Version == VISIBILITY_VERSION;
+        ok = ok && (header.Layer == LAYER_BEZIER || header.Layer == LAYER_BSPLINE) && header.Segments > 0 && header.Models < (1u << 20);
+
+        std::vector<unsigned int> firstMesh(1, 0);
+        for(uint32_t m = 0; ok && m < header.Models; m++){
+            uint32_t count;
+            ok = fread(&count, sizeof(count), 1, file) == 1 && count < (1u << 24);
+            firstMesh.push_back(firstMesh.back() + count);
+        }
+
+        unsigned int words = (firstMesh.back() + 31) / 32;
+        std::vector<uint32_t> bits;
+        if(ok && (uint64_t)header.Segments * words < (1u << 28)){
+            bits.resize(header.Segments * words);
+            ok = bits.empty() || fread(&bits[0], sizeof(uint32_t), bits.size(), file) == bits.size();
+        }
+        else
+            ok = false;
+        fclose(file);
+        if(!ok)
+            return false;
+
+        Layer = (CameraLayer)header.Layer;
+        for(unsigned int i = 0; i < 4; i++)
+            Points[i] = glm::vec3(header.Points[3 * i], header.Points[3 * i + 1], header.Points[3 * i + 2]);
+        Segments = header.Segments;
+        FirstMesh.swap(firstMesh);
+        Words = words;
+        Bits.swap(bits);
+        return true;
+    }
+
+private:
+    struct box {
+        glm::vec3 Min;
+        glm::vec3 Max;
+        bool Empty;
+    };
+
+    struct bakeScene {
+        const std::vector<occluderModel> *Models;
+        std::vector<box> Boxes;             // world bounds of every mesh, in bit order
+        std::vector<glm::vec3> Points;
+        float Far;
+        unsigned int Resolution;
+    };
+
+    static box worldBox(const glm::mat4 &transform, const occluderMesh &m)
+    {
+        box b;
+        b.Empty = m.Vertices == 0;
+        if(b.Empty)
+            return b;
+        glm::vec3 lo = OccluderVertex(m, 0), hi = lo;
+        for(unsigned int i = 1; i < m.Vertices; i++){
+            lo = glm::min(lo, OccluderVertex(m, i));
+            hi = glm::max(hi, OccluderVertex(m, i));
+        }
+        b.Min = glm::vec3(std::numeric_limits<float>::max());
+        b.Max = -b.Min;
+        for(unsigned int c = 0; c < 8; c++){
+            glm::vec3 p = glm::vec3(transform * glm::vec4(c & 1 ? hi.x : lo.x, c & 2 ? hi.y : lo.y, c & 4 ? hi.z : lo.z, 1.0f));
+            b.Min = glm::min(b.Min, p);
+            b.Max = glm::max(b.Max, p);
+        }
+        return b;
+    }
+
+    // Whether all the corners are outside one of the frustum planes
+    static bool outside(const glm::vec4 *c)
+    {
+        for(unsigned int axis = 0; axis < 3; axis++)
+            for(int sign = -1; sign <= 1; sign += 2){
+                bool all = true;
+                for(unsigned int i = 0; i < 8 && all; i++)
+                    all = sign * c[i][axis] > c[i].w;
+                if(all)
+                    return true;
+            }
+        return false;
+    }
+
+    // Looks around from every threads-th point, starting at first
+    static void bakePoints(const bakeScene *scene, std::vector< std::vector<uint32_t> > *seen, unsigned int first, unsigned int threads)
+    {
+        static const glm::vec3 directions[6] = {
+            glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1)
+        };
+        static const glm::vec3 ups[6] = {
+            glm::vec3(0, 1, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(0, 1, 0)
+        };
+
+        const std::vector<occluderModel> &models = *scene->Models;
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, NEAR, scene->Far);
+        occlusionBuffer buffer(scene->Resolution);
+        std::vector<glm::vec4> clip;
+        std::vector<unsigned char> inside(scene->Boxes.size());
+        glm::vec4 corners[8];
+
+        for(unsigned int p = first; p < scene->Points.size(); p += threads){
+            glm::vec3 eye = scene->Points[p];
+            std::vector<uint32_t> &bits = (*seen)[p];
+            for(unsigned int face = 0; face < 6; face++){
+                glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + directions[face], ups[face]);
+                buffer.Clear();
+
+                // draws every mesh in the frustum, then tests their boxes against the result
+                unsigned int bit = 0;
+                for(unsigned int m = 0; m < models.size(); m++){
+                    glm::mat4 mvp = viewProjection * models[m].Transform;
+                    for(unsigned int i = 0; i < models[m].Meshes.size(); i++, bit++){
+                        inside[bit] = !scene->Boxes[bit].Empty && !outside(boxCorners(viewProjection, scene->Boxes[bit], corners));
+                        if(!inside[bit])
+                            continue;
+                        const occluderMesh &mesh = models[m].Meshes[i];
+                        clip.resize(mesh.Vertices);
+                        for(unsigned int k = 0; k < mesh.Vertices; k++)
+                            clip[k] = mvp * glm::vec4(OccluderVertex(mesh, k), 1.0f);
+                        for(unsigned int k = 0; k + 2 < mesh.IndexCount; k += 3)
+                            buffer.DrawTriangle(clip[mesh.Indices[k]], clip[mesh.Indices[k + 1]], clip[mesh.Indices[k + 2]]);
+                    }
+                }
+
+                buffer.Erode();
+                for(bit = 0; bit < scene->Boxes.size(); bit++)
+                    if(inside[bit] && !((bits[bit / 32] >> (bit % 32)) & 1) && buffer.BoxVisible(boxCorners(viewProjection, scene->Boxes[bit], corners)))
+                        bits[bit / 32] |= 1u << (bit % 32);
+            }
+        }
+    }
+
+    static const glm::vec4 *boxCorners(const glm::mat4 &viewProjection, const box &b, glm::vec4 *corners)
+    {
+        for(unsigned int c = 0; c < 8; c++)
+            corners[c] = viewProjection * glm::vec4(c & 1 ? b.Max.x : b.Min.x, c & 2 ? b.Max.y : b.Min.y, c & 4 ? b.Max.z : b.Min.z, 1.0f);
+        return corners;
+    }
+};
+
+// Draws the meshes of a model visible from a segment, or all of them when segment is -1 or the sets
+// don't match the model
+template <typename M, typename S>
+inline void DrawVisible(M &model, S &shader, const PathVisibility &visibility, int segment, unsigned int modelIndex)
+{
+    if(segment < 0 || modelIndex >= visibility.Models() || visibility.Meshes(modelIndex) != model.meshes.size()){
+        model.Draw(shader);
+        return;
+    }
+    for(unsigned int i = 0; i < model.meshes.size(); i++)
+        if(visibility.Visible(segment, modelIndex, i))
+            model.meshes[i].Draw(shader);
+}
+#endif
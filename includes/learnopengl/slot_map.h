@@ -0,0 +1,181 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Handle to a value in a SlotMap: the slot index in the low INDEX_BITS bits and the slot's generation
+// above them. Handles are plain unsigned ints so they can go wherever camera ids go (commands,
+// recordings); 0 is never a valid handle.
+typedef unsigned int slotHandle;
+
+const slotHandle SLOT_NONE = 0;
+
+// Values kept densely packed in a vector, for fast iteration, and reached through handles that stay
+// valid while other values come and go. Insert, Remove and lookup are O(1): each slot remembers where its
+// value is in the dense array, removing moves the last value into the hole, and reusing a slot bumps its
+// generation so handles to the removed value stop working instead of pointing at the new one.
+// Freed slots are reused oldest first, so a generation only wraps after 4095 reuses of every slot.
+template <typename T>
+class SlotMap
+{
+public:
+    static const unsigned int INDEX_BITS = 20;
+    static const unsigned int INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static const unsigned int GENERATIONS = (1u << (32 - INDEX_BITS)) - 1;
+
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    SlotMap() : freeHead(NONE), freeTail(NONE) {}
+
+    // Returns SLOT_NONE when all INDEX_MASK slots are in use
+    slotHandle Insert(const T &value)
+    {
+        slotHandle h = claim();
+        if(h != SLOT_NONE)
+            values.push_back(value);
+        return h;
+    }
+
+    slotHandle Insert(T &&value)
+    {
+        slotHandle h = claim();
+        if(h != SLOT_NONE)
+            values.push_back(std::move(value));
+        return h;
+    }
+
+    // Returns false if the handle was already stale
+    bool Remove(slotHandle h)
+    {
+        if(!Contains(h))
+            return false;
+
+        unsigned int index = h & INDEX_MASK;
+        unsigned int dense = slots[index].Dense;
+        unsigned int last = (unsigned int)values.size() - 1;
+        if(dense != last){
+            values[dense] = std::move(values[last]);
+            handles[dense] = handles[last];
+            slots[handles[dense] & INDEX_MASK].Dense = dense;
+        }
+        values.pop_back();
+        handles.pop_back();
+
+        slot &s = slots[index];
+        s.Dense = NONE;
+        s.Generation = s.Generation % GENERATIONS + 1;
+        s.NextFree = NONE;
+        if(freeTail != NONE)
+            slots[freeTail].NextFree = index;
+        else
+            freeHead = index;
+        freeTail = index;
+        return true;
+    }
+
+    bool Contains(slotHandle h) const
+    {
+        unsigned int index = h & INDEX_MASK;
+        return index < slots.size() && slots[index].Generation == (h >> INDEX_BITS) && slots[index].Dense != NONE;
+    }
+
+    // NULL for stale handles
+    T *Get(slotHandle h) {
+        return Contains(h) ? &values[slots[h & INDEX_MASK].Dense] : NULL;
+    }
+
+    const T *Get(slotHandle h) const {
+        return Contains(h) ? &values[slots[h & INDEX_MASK].Dense] : NULL;
+    }
+
+    // The handle must be valid
+    T &operator[](slotHandle h) {
+        return values[slots[h & INDEX_MASK].Dense];
+    }
+
+    const T &operator[](slotHandle h) const {
+        return values[slots[h & INDEX_MASK].Dense];
+    }
+
+    // Dense access, for update passes. Removing a value changes the position of the last one
+    size_t Size() const {
+        return values.size();
+    }
+
+    bool Empty() const {
+        return values.empty();
+    }
+
+    T &At(size_t i) {
+        return values[i];
+    }
+
+    const T &At(size_t i) const {
+        return values[i];
+    }
+
+    slotHandle HandleAt(size_t i) const {
+        return handles[i];
+    }
+
+    // Position of a valid handle's value in the dense array
+    size_t IndexOf(slotHandle h) const {
+        return slots[h & INDEX_MASK].Dense;
+    }
+
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+
+    void Clear()
+    {
+        while(!handles.empty())
+            Remove(handles.back());
+    }
+
+private:
+    static const unsigned int NONE = ~0u;
+
+    struct slot {
+        unsigned int Dense;         // NONE while the slot is free
+        unsigned int Generation;
+        unsigned int NextFree;
+    };
+
+    std::vector<T> values;
+    std::vector<slotHandle> handles;        // handle of each value
+    std::vector<slot> slots;
+    unsigned int freeHead;
+    unsigned int freeTail;
+
+    slotHandle claim()
+    {
+        unsigned int index;
+        if(freeHead != NONE){
+            index = freeHead;
+            freeHead = slots[index].NextFree;
+            if(freeHead == NONE)
+                freeTail = NONE;
+        }
+        else {
+            if(slots.size() >= INDEX_MASK)
+                return SLOT_NONE;
+            index = (unsigned int)slots.size();
+            slot s;
+            s.Generation = 1;
+            slots.push_back(s);
+        }
+
+        slot &s = slots[index];
+        s.Dense = (unsigned int)values.size();
+        s.NextFree = NONE;
+        slotHandle h = (s.Generation << INDEX_BITS) | index;
+        handles.push_back(h);
+        return h;
+    }
+};
+#endif
@@ -0,0 +1,141 @@
+#ifndef SPLINE_PATH_H
+#define SPLINE_PATH_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/curve_kernels.h>
+
+#include <algorithm>
+#include <vector>
+
+// A piecewise cubic path through any number of control points, with its own duration for every segment.
+// Each segment is stored in power form, so evaluating it is a Horner step with no branches; the segment
+// for a time is found by binary search over the segment end times, or in O(1) through a cursor that the
+// caller keeps between calls (the usual case, where time only moves forward a little each frame).
+class SplinePath
+{
+public:
+    // End time of every segment, measured from the start of the path
+    std::vector<float> SegmentEnd;
+
+    // Catmull-Rom through all the points, with the end points repeated like Camera::bSplinePath does.
+    // n points give n - 1 segments, all with the same duration.
+    static SplinePath CatmullRom(const std::vector<glm::vec3> &points, float time)
+    {
+        return CatmullRom(points, uniformTimes(points.size() > 1 ? points.size() - 1 : 0, time));
+    }
+
+    // Same, with one duration per segment
+    static SplinePath CatmullRom(const std::vector<glm::vec3> &points, const std::vector<float> &segmentTimes)
+    {
+        SplinePath path;
+        unsigned int n = points.size();
+        for(unsigned int k = 0; k + 1 < n; k++){
+            glm::vec3 p0 = points[k > 0 ? k - 1 : 0];
+            glm::vec3 p3 = points[k + 2 < n ? k + 2 : n - 1];
+            path.addSegment(CATMULL_ROM_BASIS, p0, points[k], points[k + 1], p3, segmentTime(segmentTimes, k));
+        }
+        path.setStart(points);
+        return path;
+    }
+
+    // Cubic Bezier segments sharing their end points: 3k + 1 points give k segments,
+    // points that don't complete a segment are ignored. All segments have the same duration.
+    static SplinePath Bezier(const std::vector<glm::vec3> &points, float time)
+    {
+        return Bezier(points, uniformTimes(points.size() > 1 ? (points.size() - 1) / 3 : 0, time));
+    }
+
+    // Same, with one duration per segment
+    static SplinePath Bezier(const std::vector<glm::vec3> &points, const std::vector<float> &segmentTimes)
+    {
+        SplinePath path;
+        for(unsigned int k = 0; 3 * k + 3 < points.size(); k++)
+            path.addSegment(BEZIER_BASIS, points[3 * k], points[3 * k + 1], points[3 * k + 2], points[3 * k + 3], segmentTime(segmentTimes, k));
+        path.setStart(points);
+        return path;
+    }
+
+    unsigned int Segments() const {
+        return SegmentEnd.size();
+    }
+
+    float Duration() const {
+        return SegmentEnd.empty() ? 0 : SegmentEnd.back();
+    }
+
+    // Index of the segment that contains time. The cursor is tried first, then its successor,
+    // and only then the binary search; it is updated with the result.
+    unsigned int FindSegment(float time, unsigned int &cursor) const
+    {
+        unsigned int n = Segments();
+        if(cursor < n && time <= SegmentEnd[cursor] && (cursor == 0 || time > SegmentEnd[cursor - 1]))
+            return cursor;
+        if(cursor + 1 < n && time > SegmentEnd[cursor] && time <= SegmentEnd[cursor + 1])
+            return ++cursor;
+
+        cursor = std::lower_bound(SegmentEnd.begin(), SegmentEnd.end(), time) - SegmentEnd.begin();
+        if(cursor >= n)
+            cursor = n - 1;
+        return cursor;
+    }
+
+    // Position at a time since the start of the path, clamped to the path duration
+    glm::vec3 Evaluate(float time, unsigned int &cursor) const
+    {
+        if(SegmentEnd.empty())
+            return start;
+
+        unsigned int k = FindSegment(time, cursor);
+        float begin = k > 0 ? SegmentEnd[k - 1] : 0;
+        float duration = SegmentEnd[k] - begin;
+        float t = duration > 0 ? std::min(std::max((time - begin) / duration, 0.0f), 1.0f) : 1.0f;
+
+        const glm::vec3 *c = &coefficients[4 * k];
+        return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+    }
+
+    glm::vec3 Evaluate(float time) const
+    {
+        unsigned int cursor = 0;
+        return Evaluate(time, cursor);
+    }
+
+    // Position at a fraction of the duration, so the path can be baked with CameraPath::FromCurve
+    glm::vec3 operator()(float fraction) const
+    {
+        return Evaluate(fraction * Duration());
+    }
+
+private:
+    // Four power coefficients per segment
+    std::vector<glm::vec3> coefficients;
+    glm::vec3 start;
+
+    static std::vector<float> uniformTimes(unsigned int segments, float time)
+    {
+        return std::vector<float>(segments, segments > 0 ? time / segments : 0);
+    }
+
+    static float segmentTime(const std::vector<float> &segmentTimes, unsigned int k)
+    {
+        return k < segmentTimes.size() ? std::max(segmentTimes[k], 0.0f) : 0;
+    }
+
+    void addSegment(const CubicBasis &basis, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float time)
+    {
+        glm::vec4 x = CubicCoefficients(basis, p0.x, p1.x, p2.x, p3.x);
+        glm::vec4 y = CubicCoefficients(basis, p0.y, p1.y, p2.y, p3.y);
+        glm::vec4 z = CubicCoefficients(basis, p0.z, p1.z, p2.z, p3.z);
+        for(int i = 0; i < 4; i++)
+            coefficients.push_back(glm::vec3(x[i], y[i], z[i]));
+
+        SegmentEnd.push_back(Duration() + time);
+    }
+
+    void setStart(const std::vector<glm::vec3> &points)
+    {
+        start = points.empty() ? glm::vec3(0) : points[0];
+    }
+};
+#endif
@@ -0,0 +1,39 @@
+#ifndef VIEW_FRUSTUM_H
+#define VIEW_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// The six planes bounding what a projection * view matrix can see (left, right, bottom, top, near, far),
+// each as (normal, distance) with the normal pointing inside and normalized, so plane . (p, 1) is the
+// signed distance from p
+struct viewFrustum {
+    glm::vec4 Planes[6];
+};
+
+// Planes of a projection * view matrix, taken from its rows (Gribb and Hartmann)
+inline viewFrustum FrustumFromMatrix(const glm::mat4 &m)
+{
+    glm::vec4 rows[4];
+    for(unsigned int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+    viewFrustum f;
+    for(unsigned int i = 0; i < 3; i++){
+        f.Planes[2 * i] = rows[3] + rows[i];
+        f.Planes[2 * i + 1] = rows[3] - rows[i];
+    }
+    for(unsigned int i = 0; i < 6; i++)
+        f.Planes[i] /= glm::length(glm::vec3(f.Planes[i]));
+    return f;
+}
+
+// Whether a sphere is at least partly inside. Some spheres just outside a corner count as inside too:
+// the test can keep an invisible sphere but never drops a visible one
+inline bool SphereInFrustum(const viewFrustum &f, glm::vec3 center, float radius)
+{
+    for(unsigned int i = 0; i < 6; i++)
+        if(glm::dot(glm::vec3(f.Planes[i]), center) + f.Planes[i].w < -radius)
+            return false;
+    return true;
+}
+#endif
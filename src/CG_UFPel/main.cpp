@@ -7,25 +7,40 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader_m.h>
+#include <learnopengl/asset_prefetch.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/camera_collision.h>
+#include <learnopengl/camera_commands.h>
+#include <learnopengl/camera_recorder.h>
+#include <learnopengl/camera_scheduler.h>
+#include <learnopengl/camera_snapshot.h>
 #include <learnopengl/model.h>
+#include <learnopengl/path_visibility.h>
+#include <learnopengl/slot_map.h>
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 void printCameraData();
 void changeCamera();
 void createCamera();
+void destroyCamera();
+void simulate();
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
 // camera
-vector<Camera> cameras;
-unsigned int currentCamera = 0;
-unsigned int numberOfCameras = 1;
+FunctionClock glfwClock(glfwGetTime);
+// cameras are addressed by handles, that stay valid while other cameras are created and destroyed
+SlotMap<Camera> cameras;
+slotHandle currentCamera = SLOT_NONE;
 // default camera configuration values
 glm::vec3 position = glm::vec3(0,20,3);
 glm::vec3 up = glm::vec3(0,1,0);
@@ -35,7 +50,7 @@ float near = 0.01f;
 float far = 100.0f;
 
 // camera controls
-bool tab = false, enter = false;
+bool tab = false, enter = false, backspace = false;
 
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 float lastX = SCR_WIDTH / 2.0f;
@@ -47,6 +62,36 @@ bool t1 = false, t2 = false, t3 = false;
 bool ra1 = false, ra2 = false, ra3 = false;
 bool rp1 = false, rp2 = false, rp3 = false;
 bool b1 = false, s1 = false;
+bool n1 = false;
+bool c1 = false;
+bool v1 = false;
+bool x1 = false;
+
+// records every camera's pose each frame while on (C key)
+CameraRecorder recorder;
+unsigned int frameNumber = 0;
+
+// transformations submitted from other threads, applied once per frame
+CameraCommandChannel commands;
+// commands that run at a later time
+CameraScheduler scheduler;
+
+// the cameras run on their own thread, which publishes the current camera's snapshot for the render loop
+// to draw with; everything else that reads or changes the cameras takes the lock
+TripleBuffer<cameraSnapshot> currentView;
+std::mutex cameraLock;
+std::atomic<bool> simulating(false);
+const std::chrono::microseconds SIMULATION_STEP(1000000 / 240);
+
+// control points of the Bezier (B key) and b-spline (S key) paths
+const glm::vec3 curvePoints[4] = { glm::vec3(0,0,0), glm::vec3(0,10,-10), glm::vec3(0,10,10), glm::vec3(5,5,5) };
+// meshes visible along each of them, baked with the V key
+PathVisibility bezierVisibility, bSplineVisibility;
+bool bakeVisibility = false;
+
+// the city's triangles, which the cameras can't fly through while collision is on (X key)
+SceneCollider cityCollider;
+bool collision = false;
 
 // timing
 float deltaTime = 0.0f;
@@ -98,14 +143,50 @@ int main()
 
     // load models
     // -----------
+    // the city is always on screen; the other models are loaded in the background shortly before the
+    // current camera gets to see them
     Model city(FileSystem::getPath("resources/objects/city/Castelia City.obj"));
-    Model rock(FileSystem::getPath("resources/objects/rock/rock.obj"));
-    Model planet(FileSystem::getPath("resources/objects/planet/planet.obj"));
-    Model cyborg(FileSystem::getPath("resources/objects/cyborg/cyborg.obj"));
+    Model rock(FileSystem::getPath("resources/objects/rock/rock.obj"), false, true);
+    Model planet(FileSystem::getPath("resources/objects/planet/planet.obj"), false, true);
+    Model cyborg(FileSystem::getPath("resources/objects/cyborg/cyborg.obj"), false, true);
+    StreamedAssetOf<Model> rockAsset(&rock), planetAsset(&planet), cyborgAsset(&cyborg);
+
+    // declared after the models, so its loader thread stops before they go away
+    AssetPrefetcher prefetcher;
+    unsigned int rockId = prefetcher.Add(&rockAsset, glm::vec3(0, 10, -10), 3.0f);
+    unsigned int planetId = prefetcher.Add(&planetAsset, glm::vec3(0, 10, 10), 3.0f);
+    unsigned int cyborgId = prefetcher.Add(&cyborgAsset, glm::vec3(5, 5, 5), 3.0f);
+
+    // model matrices
+    glm::mat4 cityMatrix = glm::mat4(1);
+    cityMatrix = glm::translate(cityMatrix, glm::vec3(0.0f, -1.75f, 0.0f)); // translate it down so it's at the center of the scene
+    cityMatrix = glm::scale(cityMatrix, glm::vec3(0.002f, 0.002f, 0.002f));	// it's a bit too big for our scene, so scale it down
+    glm::mat4 rockMatrix = glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, 10, -10)), glm::vec3(0.2));
+    glm::mat4 planetMatrix = glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, 10, 10)), glm::vec3(0.2));
+    glm::mat4 cyborgMatrix = glm::scale(glm::translate(glm::mat4(1), glm::vec3(5, 5, 5)), glm::vec3(0.2));
+
+    // visibility baked by an earlier run, if any
+    bezierVisibility.Load("bezier.pvs");
+    bSplineVisibility.Load("bspline.pvs");
+
+    // collision geometry, built once and cached in city.bvh
+    std::vector<occluderModel> collisionScene(1, OccluderFromModel(city, cityMatrix));
+    BvhCacheResult cache = cityCollider.Tree.BuildOrLoad(collisionScene, "city.bvh");
+    if(cache == BVH_SAVED)
+        printf("| Collision tree saved to city.bvh, %u triangles\n", (unsigned int)cityCollider.Tree.Triangles.size());
+    else if(cache == BVH_NOT_SAVED)
+        printf("| Collision tree built, %u triangles, but city.bvh couldn't be written\n", (unsigned int)cityCollider.Tree.Triangles.size());
     
     // creates a default camera at 0,5,3
     Camera newCamera = Camera(glm::vec3(0, 5, 3));
-    cameras.push_back(newCamera);
+    newCamera.Clock = &glfwClock;
+    currentCamera = cameras.Insert(newCamera);
+
+    // a first snapshot, so the first frame has a camera to draw with
+    CaptureSnapshot(cameras[currentCamera], SCR_WIDTH, SCR_HEIGHT, currentView.Back());
+    currentView.Publish();
+    simulating = true;
+    std::thread simulation(simulate);
 
     // draw in wireframe
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -120,9 +201,56 @@ int main()
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // input
-        // -----
-        processInput(window);
+        // bakes the meshes visible along the Bezier and b-spline paths, once every model is loaded
+        if(bakeVisibility){
+            prefetcher.Require(rockId);
+            prefetcher.Require(planetId);
+            prefetcher.Require(cyborgId);
+            std::vector<occluderModel> scene;
+            scene.push_back(OccluderFromModel(city, cityMatrix));
+            scene.push_back(OccluderFromModel(rock, rockMatrix));
+            scene.push_back(OccluderFromModel(planet, planetMatrix));
+            scene.push_back(OccluderFromModel(cyborg, cyborgMatrix));
+            bezierVisibility = PathVisibility::Bake(LAYER_BEZIER, curvePoints[0], curvePoints[1], curvePoints[2], curvePoints[3], scene);
+            bSplineVisibility = PathVisibility::Bake(LAYER_BSPLINE, curvePoints[0], curvePoints[1], curvePoints[2], curvePoints[3], scene);
+            bezierVisibility.Save("bezier.pvs");
+            bSplineVisibility.Save("bspline.pvs");
+            printf("| Visibility saved to bezier.pvs and bspline.pvs\n");
+            bakeVisibility = false;
+        }
+
+        // input, and everything else that reads or changes the cameras, while the simulation waits
+        // -----------------------------------------------------------------------------------------
+        const PathVisibility *visibility = &bezierVisibility;
+        int segment;
+        {
+            std::lock_guard<std::mutex> lock(cameraLock);
+            processInput(window);
+
+            // start loading what the camera will see in the next seconds
+            prefetcher.Update(cameras[currentCamera], glfwClock.Now(), (float)SCR_WIDTH / (float)SCR_HEIGHT);
+            printCameraData();
+
+            if(recorder.IsRecording()){
+                for(unsigned int i = 0; i < cameras.Size(); i++){
+                    slotHandle h = cameras.HandleAt(i);
+                    if(h != currentCamera)
+                        cameras.At(i).evaluateAt(glfwClock.Now());
+                    recorder.Record(frameNumber, h, cameras.At(i));
+                }
+            }
+
+            // on a baked path only the meshes visible from the current segment are drawn, elsewhere all of them
+            segment = bezierVisibility.Segment(cameras[currentCamera]);
+            if(segment < 0){
+                visibility = &bSplineVisibility;
+                segment = bSplineVisibility.Segment(cameras[currentCamera]);
+            }
+        }
+        frameNumber++;
+
+        // upload one decoded model per frame
+        prefetcher.Upload(1);
 
         // render
         // ------
@@ -132,38 +260,31 @@ int main()
         // don't forget to enable shader before setting uniforms
         ourShader.use();
 
-        // view/projection transformations
-        glm::mat4 projection = cameras[currentCamera].GetProjectionMatrix(SCR_WIDTH, SCR_HEIGHT);
-        glm::mat4 view = cameras[currentCamera].GetViewMatrix();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
-        printCameraData();
+        // view/projection transformations, from the latest snapshot the simulation published
+        currentView.Update();
+        ourShader.setMat4("projection", currentView.Front().Projection);
+        ourShader.setMat4("view", currentView.Front().View);
 
         // render the loaded model
-        glm::mat4 model = glm::mat4(1);
-        model = glm::translate(model, glm::vec3(0.0f, -1.75f, 0.0f)); // translate it down so it's at the center of the scene
-        model = glm::scale(model, glm::vec3(0.002f, 0.002f, 0.002f));	// it's a bit too big for our scene, so scale it down
-        ourShader.setMat4("model", model);
-        city.Draw(ourShader);
+        ourShader.setMat4("model", cityMatrix);
+        DrawVisible(city, ourShader, *visibility, segment, 0);
         
 
-        model = glm::mat4(1);
-        model = glm::translate(model, glm::vec3(0, 10, -10));
-        model = glm::scale(model, glm::vec3(0.2));
-        ourShader.setMat4("model", model);
-        rock.Draw(ourShader);
+        // models still loading are skipped for now
+        if(prefetcher.Ready(rockId)){
+            ourShader.setMat4("model", rockMatrix);
+            DrawVisible(rock, ourShader, *visibility, segment, 1);
+        }
 
-        model = glm::mat4(1);
-        model = glm::translate(model, glm::vec3(0, 10, 10));
-        model = glm::scale(model, glm::vec3(0.2));
-        ourShader.setMat4("model", model);
-        planet.Draw(ourShader);
+        if(prefetcher.Ready(planetId)){
+            ourShader.setMat4("model", planetMatrix);
+            DrawVisible(planet, ourShader, *visibility, segment, 2);
+        }
 
-        model = glm::mat4(1);
-        model = glm::translate(model, glm::vec3(5, 5, 5));
-        model = glm::scale(model, glm::vec3(0.2));
-        ourShader.setMat4("model", model);
-        cyborg.Draw(ourShader);
+        if(prefetcher.Ready(cyborgId)){
+            ourShader.setMat4("model", cyborgMatrix);
+            DrawVisible(cyborg, ourShader, *visibility, segment, 3);
+        }
 
 
 
@@ -173,6 +294,10 @@ int main()
         glfwPollEvents();
     }
 
+    simulating = false;
+    simulation.join();
+    recorder.Stop();
+
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
@@ -180,6 +305,21 @@ int main()
 }
 
 
+// The simulation thread: runs the commands from other threads and the scheduled ones, brings the current
+// camera up to the clock and publishes its snapshot, a few times per rendered frame
+void simulate(){
+    while(simulating){
+        {
+            std::lock_guard<std::mutex> lock(cameraLock);
+            commands.Drain(cameras);
+            scheduler.Update(glfwClock.Now(), cameras);
+            CaptureSnapshot(cameras[currentCamera], SCR_WIDTH, SCR_HEIGHT, currentView.Back());
+        }
+        currentView.Publish();
+        std::this_thread::sleep_for(SIMULATION_STEP);
+    }
+}
+
 void printCameraData(){
     printf("----------------- New camera data ------------------\n");
     printf("| Position Value: (%f %f %f)\n", position.x, position.y, position.z);
@@ -190,8 +330,8 @@ void printCameraData(){
     printf("| Far clipping: %f\n", far);
 
     printf("\n--------------- Current camera data ---------------\n");
-    printf("| Number of Cameras: %u\n", numberOfCameras);
-    printf("| Current camera id: %u\n", currentCamera);
+    printf("| Number of Cameras: %u\n", (unsigned int)cameras.Size());
+    printf("| Current camera: %u (handle %u)\n", (unsigned int)cameras.IndexOf(currentCamera), currentCamera);
     printf("| Position Value: (%f %f %f)\n", cameras[currentCamera].Position.x, cameras[currentCamera].Position.y, cameras[currentCamera].Position.z);
     printf("| Up Vector Value: (%f %f %f)\n", cameras[currentCamera].Up.x, cameras[currentCamera].Up.y, cameras[currentCamera].Up.z);
     printf("| Front Vector Value: (%f %f %f)\n", cameras[currentCamera].Front.x, cameras[currentCamera].Front.y, cameras[currentCamera].Front.z);
@@ -202,16 +342,24 @@ void printCameraData(){
 }
 
 void changeCamera() {
-    if(numberOfCameras - 1 == currentCamera)
-        currentCamera = 0;
-    else
-        ++currentCamera;
+    size_t next = cameras.IndexOf(currentCamera) + 1;
+    currentCamera = cameras.HandleAt(next < cameras.Size() ? next : 0);
 }
 
 void createCamera() {
     Camera newCamera = Camera(position, up, front, zoom, near, far);
-    cameras.push_back(newCamera);
-    ++numberOfCameras;
+    newCamera.Clock = &glfwClock;
+    newCamera.Collider = collision ? &cityCollider : NULL;
+    cameras.Insert(newCamera);
+}
+
+// Destroys the current camera and switches to the next one. The last camera is kept
+void destroyCamera() {
+    if(cameras.Size() < 2)
+        return;
+    slotHandle old = currentCamera;
+    changeCamera();
+    cameras.Remove(old);
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
@@ -237,6 +385,14 @@ void processInput(GLFWwindow *window)
         createCamera();
     }
 
+    // Destroying camera
+    if (glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_PRESS)
+        backspace = true;
+    if (glfwGetKey(window, GLFW_KEY_BACKSPACE) == GLFW_RELEASE && backspace){
+        backspace = false;
+        destroyCamera();
+    }
+
     // LookAt
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)   obj1 = true;
     if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)   obj2 = true;
@@ -310,29 +466,56 @@ void processInput(GLFWwindow *window)
     // Bezier
     if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS)   b1 = true;
     if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE && b1){
-        cameras[currentCamera].bezierPath(
-            glm::vec3(0,0,0),
-            glm::vec3(0,10,-10),
-            glm::vec3(0,10,10),
-            glm::vec3(5,5,5), 
-            5
-        );
+        cameras[currentCamera].bezierPath(curvePoints[0], curvePoints[1], curvePoints[2], curvePoints[3], 5);
         b1 = false;
     }
 
     // bSpline
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)   s1 = true;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_RELEASE && s1){
-        cameras[currentCamera].bSplinePath(
-            glm::vec3(0,0,0),
-            glm::vec3(0,10,-10),
-            glm::vec3(0,10,10),
-            glm::vec3(5,5,5), 
-            5
-        );
+        cameras[currentCamera].bSplinePath(curvePoints[0], curvePoints[1], curvePoints[2], curvePoints[3], 5);
         s1 = false;
     }
 
+    // Noise
+    if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS)   n1 = true;
+    if (glfwGetKey(window, GLFW_KEY_N) == GLFW_RELEASE && n1){
+        if(cameras[currentCamera].noiseActive)
+            cameras[currentCamera].StopNoise();
+        else
+            cameras[currentCamera].StartNoise(0.05f, glm::radians(1.0f), 1.5f, 3, cameras.IndexOf(currentCamera) * 7.0f);
+        n1 = false;
+    }
+
+    // Recording
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS)   c1 = true;
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE && c1){
+        if(recorder.IsRecording()){
+            recorder.Stop();
+            printf("| Recording saved to cameras.rec, %llu poses dropped\n", recorder.Dropped());
+        }
+        else
+            recorder.Start("cameras.rec");
+        c1 = false;
+    }
+
+    // Bake the visibility along the Bezier and b-spline paths
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS)   v1 = true;
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE && v1){
+        bakeVisibility = true;
+        v1 = false;
+    }
+
+    // Collision with the city, for every camera
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS)   x1 = true;
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE && x1){
+        collision = !collision;
+        for(size_t i = 0; i < cameras.Size(); i++)
+            cameras[cameras.HandleAt(i)].Collider = collision ? &cityCollider : NULL;
+        printf("| Collision %s\n", collision ? "on" : "off");
+        x1 = false;
+    }
+
 
 
 }
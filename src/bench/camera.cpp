@@ -0,0 +1,304 @@
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_clock.h>
+#include <learnopengl/camera_group.h>
+#include <learnopengl/camera_system.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Headless camera animation benchmark: no window or GL context is created.
+// Runs the transformations from camera.h on growing numbers of cameras, with Camera and with CameraSystem
+// on 1..threads threads, and reports ns/camera/frame (for CameraSystem also of Update alone) and heap
+// allocations per frame. Then moves a rig of
+// cameras along one rail, each camera with its own copy of the curve and as a CameraGroup.
+// Both paths of each test must end in the same poses; if they don't, it prints the difference and exits with 1.
+// usage: bench_camera [max cameras] [frames] [max threads]
+
+// every heap allocation made by the process goes through here. All the forms of new and delete are
+// replaced together, so memory from malloc is always given back to free
+static unsigned long long allocations = 0;
+
+static void *countedAllocate(std::size_t size)
+{
+    ++allocations;
+    void *p = std::malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+const float FRAME_TIME = 1.0f / 60.0f;
+
+// Queues rounds of LookAt, Translate, rotateRA, rotateRP, Bezier and B-spline, each camera with its own
+// mix and targets, enough to keep every camera busy for the whole run
+template <typename Queue>
+void queueWorkload(unsigned int i, float seconds, Queue queue)
+{
+    glm::vec3 a = glm::vec3((float)(i % 7), 10, -10);
+    glm::vec3 b = glm::vec3(0, 10, 10);
+    glm::vec3 c = glm::vec3(5, 5, (float)(i % 5));
+
+    // some take no time at all, and must land on their end right away
+    for(float t = 0; t < seconds; t += 3){
+        switch((i + (unsigned int)t) % 6){
+            case 0: queue.lookAt(a, 1.5f); queue.lookAt(b, 1.5f); break;
+            case 1: queue.translate(a, 1.5f); queue.translate(b, 0); queue.translate(c, 1.5f); break;
+            case 2: queue.rotateRA(glm::vec3(0, 1, 0), glm::radians(90.0f), 3); break;
+            case 3: queue.rotateRP(b, glm::radians(20.0f), 0); queue.rotateRP(b, glm::radians(45.0f), 3); break;
+            case 4: queue.bezier(c, b, a, glm::vec3(0), 0); queue.bezier(glm::vec3(0), a, b, c, 3); break;
+            case 5: queue.bSpline(glm::vec3(0), a, b, c, 3); break;
+        }
+    }
+}
+
+struct CameraQueue {
+    Camera *c;
+    void lookAt(glm::vec3 p, float t){ c->LookAt(p, t); }
+    void translate(glm::vec3 p, float t){ c->Translate(p, t); }
+    void rotateRA(glm::vec3 axis, float angle, float t){ c->rotateRA(axis, angle, t); }
+    void rotateRP(glm::vec3 p, float angle, float t){ c->rotateRP(p, angle, t); }
+    void bezier(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t){ c->bezierPath(p0, p1, p2, p3, t); }
+    void bSpline(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t){ c->bSplinePath(p0, p1, p2, p3, t); }
+};
+
+struct SystemQueue {
+    CameraSystem *s;
+    unsigned int id;
+    void lookAt(glm::vec3 p, float t){ s->LookAt(id, p, t); }
+    void translate(glm::vec3 p, float t){ s->Translate(id, p, t); }
+    void rotateRA(glm::vec3 axis, float angle, float t){ s->rotateRA(id, axis, angle, t); }
+    void rotateRP(glm::vec3 p, float angle, float t){ s->rotateRP(id, p, angle, t); }
+    void bezier(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t){ s->bezierPath(id, p0, p1, p2, p3, t); }
+    void bSpline(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t){ s->bSplinePath(id, p0, p1, p2, p3, t); }
+};
+
+struct Result {
+    double nsPerCameraFrame;
+    double allocationsPerFrame;
+    double updateNsPerCameraFrame;      // CameraSystem::Update alone, without building the view matrices
+};
+
+void printResult(const char *name, unsigned int threads, Result r)
+{
+    printf("| %-12s %2u thread(s) %10.1f ns/camera/frame %10.1f allocations/frame", name, threads, r.nsPerCameraFrame, r.allocationsPerFrame);
+    if(r.updateNsPerCameraFrame > 0)
+        printf(", update only %6.1f ns", r.updateNsPerCameraFrame);
+    printf("\n");
+}
+
+Result runCameras(std::vector<Camera> &cameras, unsigned int frames)
+{
+    FixedStepClock clock(FRAME_TIME);
+    for(unsigned int i = 0; i < cameras.size(); i++)
+        cameras[i].Clock = &clock;
+
+    float checksum = 0;
+    unsigned long long before = allocations;
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    for(unsigned int f = 0; f < frames; f++, clock.Tick())
+        for(unsigned int i = 0; i < cameras.size(); i++)
+            checksum += cameras[i].GetViewMatrix()[3][0];
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+    Result r = { seconds * 1e9 / ((double)frames * cameras.size()), (double)(allocations - before) / frames, 0 };
+    if(checksum != checksum)
+        printf("| Camera produced NaNs\n");
+    return r;
+}
+
+Result runSystem(CameraSystem &system, unsigned int frames, unsigned int threads)
+{
+    float checksum = 0;
+    double updateSeconds = 0;
+    unsigned long long before = allocations;
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    for(unsigned int f = 0; f < frames; f++){
+        std::chrono::high_resolution_clock::time_point updateBegin = std::chrono::high_resolution_clock::now();
+        system.Update(f * FRAME_TIME, threads);
+        updateSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - updateBegin).count();
+        for(unsigned int i = 0; i < system.Size(); i++)
+            checksum += system.GetViewMatrix(i)[3][0];
+        // the first frame starts the worker threads; the allocations are counted from the next one
+        if(f == 0)
+            before = allocations;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+    Result r = { seconds * 1e9 / ((double)frames * system.Size()), (double)(allocations - before) / std::max(frames - 1, 1u), updateSeconds * 1e9 / ((double)frames * system.Size()) };
+    if(checksum != checksum)
+        printf("| CameraSystem produced NaNs\n");
+    return r;
+}
+
+// The rail of the rig test: Bezier segments one after the other, for the whole run
+template <typename Queue>
+void queueRail(glm::vec3 offset, float seconds, Queue queue)
+{
+    for(float t = 0; t < seconds; t += 3){
+        float x = t * 4;
+        queue.bezier(glm::vec3(x, 5, 0) + offset, glm::vec3(x + 4, 9, -6) + offset, glm::vec3(x + 8, 1, 6) + offset, glm::vec3(x + 12, 5, 0) + offset, 3);
+    }
+}
+
+// The rig test only times the poses: building the view matrices costs the same either way
+Result runRigCopies(std::vector<Camera> &cameras, unsigned int frames)
+{
+    float checksum = 0;
+    unsigned long long before = allocations;
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    for(unsigned int f = 0; f < frames; f++)
+        for(unsigned int i = 0; i < cameras.size(); i++){
+            cameras[i].evaluateAt(f * FRAME_TIME);
+            checksum += cameras[i].Position.x;
+        }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+    Result r = { seconds * 1e9 / ((double)frames * cameras.size()), (double)(allocations - before) / frames, 0 };
+    if(checksum != checksum)
+        printf("| Camera produced NaNs\n");
+    return r;
+}
+
+Result runGroup(CameraGroup &group, unsigned int frames)
+{
+    float checksum = 0;
+    unsigned long long before = allocations;
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    for(unsigned int f = 0; f < frames; f++){
+        group.Update(f * FRAME_TIME);
+        checksum += group.Positions.x[f % group.Size()];
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+    Result r = { seconds * 1e9 / ((double)frames * group.Size()), (double)(allocations - before) / frames, 0 };
+    if(checksum != checksum)
+        printf("| CameraGroup produced NaNs\n");
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int maxCameras = argc > 1 ? atoi(argv[1]) : 16384;
+    unsigned int frames = argc > 2 ? atoi(argv[2]) : 600;
+    unsigned int maxThreads = argc > 3 ? atoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    float seconds = frames * FRAME_TIME;
+
+    printf("frames: %u (%.1f s of animation), hardware threads: %u, sizeof(Camera): %u bytes\n", frames, seconds, std::thread::hardware_concurrency(), (unsigned int)sizeof(Camera));
+
+    float worst = 0;
+    for(unsigned int count = 64; count <= maxCameras; count *= 4){
+        std::vector<Camera> cameras;
+        cameras.reserve(count);
+        CameraSystem system;
+        for(unsigned int i = 0; i < count; i++){
+            cameras.push_back(Camera(glm::vec3(0, 5, 3)));
+            CameraQueue cq = { &cameras[i] };
+            queueWorkload(i, seconds, cq);
+
+            SystemQueue sq = { &system, system.Add(glm::vec3(0, 5, 3)) };
+            queueWorkload(i, seconds, sq);
+        }
+
+        printf("cameras: %u\n", count);
+        printResult("Camera", 1, runCameras(cameras, frames));
+
+        CameraSystem reference = system;
+        for(unsigned int threads = 1; threads <= maxThreads; threads *= 2){
+            CameraSystem copy = system;
+            printResult("CameraSystem", threads, runSystem(copy, frames, threads));
+            reference = copy;
+        }
+
+        // both paths follow the same rules, so they must end in the same place; written so a NaN is kept
+        for(unsigned int i = 0; i < count; i++){
+            float position = glm::length(cameras[i].Position - reference.Position.get(i));
+            float front = glm::length(cameras[i].Front - reference.Front.get(i));
+            if(!(position <= worst))
+                worst = position;
+            if(!(front <= worst))
+                worst = front;
+        }
+    }
+
+    printf("largest difference between Camera and CameraSystem: %g\n", worst);
+    if(!(worst < 1e-2f)){
+        printf("Camera and CameraSystem disagree\n");
+        return 1;
+    }
+
+    // a rig: every camera at its own offset from one rail. The rig doesn't turn along a Bezier path, so
+    // offsetting each camera's copy of the curve puts it where the group does
+    float worstRig = 0;
+    for(unsigned int count = 64; count <= maxCameras; count *= 4){
+        std::vector<Camera> cameras, members;
+        cameras.reserve(count);
+        CameraGroup group;
+        CameraQueue rig = { &group.Rig };
+        queueRail(glm::vec3(0), seconds, rig);
+        for(unsigned int i = 0; i < count; i++){
+            glm::vec3 offset((float)(i % 8) - 3.5f, (float)(i / 8 % 8) * 0.5f, -(float)(i / 64));
+            cameras.push_back(Camera());
+            CameraQueue cq = { &cameras[i] };
+            queueRail(offset, seconds, cq);
+
+            members.push_back(Camera());
+            group.Add(i, offset);
+        }
+
+        printf("rig of %u cameras\n", count);
+        printResult("Camera", 1, runRigCopies(cameras, frames));
+        printResult("CameraGroup", 1, runGroup(group, frames));
+        group.Apply(members);
+
+        for(unsigned int i = 0; i < count; i++){
+            worstRig = std::max(worstRig, glm::length(cameras[i].Position - members[i].Position));
+            worstRig = std::max(worstRig, glm::length(cameras[i].Front - members[i].Front));
+        }
+    }
+
+    printf("largest difference between Camera copies and CameraGroup: %g\n", worstRig);
+    if(!(worstRig < 1e-2f)){
+        printf("Camera copies and CameraGroup disagree\n");
+        return 1;
+    }
+    return 0;
+}
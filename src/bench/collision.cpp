@@ -0,0 +1,231 @@
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera_collision.h>
+#include <learnopengl/camera_system.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Camera collision against a synthetic city: a grid of boxes whose walls are split into many triangles.
+// Builds the BVH on 1..threads threads, saves and loads it, then flies cameras through the streets with
+// and without the collider and reports ns/camera/frame. A sample of random sweeps is checked against testing
+// every triangle, and no camera may end up inside a building; if either fails, it prints it and exits with 1.
+// usage: bench_collision [blocks per side] [cameras] [frames] [max threads]
+
+const float FRAME_TIME = 1.0f / 60.0f;
+const float BLOCK = 10.0f;          // a building and a street
+const float BUILDING = 6.0f;
+
+// testing every triangle takes milliseconds a sweep, and many times that without optimizations, so only
+// this many sweeps are checked that way
+#ifdef NDEBUG
+const unsigned int CHECKED_SWEEPS = 500;
+#else
+const unsigned int CHECKED_SWEEPS = 40;
+#endif
+
+struct Timer {
+    std::chrono::high_resolution_clock::time_point begin;
+    Timer() : begin(std::chrono::high_resolution_clock::now()) {}
+    double seconds() const { return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count(); }
+};
+
+float randomIn(float lo, float hi)
+{
+    return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+float height(unsigned int i, unsigned int j)
+{
+    return 4.0f + (float)((i * 7 + j * 13) % 11);
+}
+
+// One quad of a wall, split into n * n pairs of triangles
+void addQuad(std::vector<bvhTriangle> &triangles, glm::vec3 origin, glm::vec3 u, glm::vec3 v, unsigned int n)
+{
+    for(unsigned int a = 0; a < n; a++)
+        for(unsigned int b = 0; b < n; b++){
+            glm::vec3 p = origin + u * ((float)a / n) + v * ((float)b / n);
+            glm::vec3 du = u / (float)n, dv = v / (float)n;
+            bvhTriangle t0 = {{ p, p + du, p + du + dv }};
+            bvhTriangle t1 = {{ p, p + du + dv, p + dv }};
+            triangles.push_back(t0);
+            triangles.push_back(t1);
+        }
+}
+
+void buildCity(unsigned int blocks, unsigned int split, std::vector<bvhTriangle> &triangles)
+{
+    for(unsigned int i = 0; i < blocks; i++)
+        for(unsigned int j = 0; j < blocks; j++){
+            glm::vec3 o(i * BLOCK, 0, j * BLOCK);
+            glm::vec3 x(BUILDING, 0, 0), y(0, height(i, j), 0), z(0, 0, BUILDING);
+            addQuad(triangles, o, x, y, split);
+            addQuad(triangles, o + z, x, y, split);
+            addQuad(triangles, o, z, y, split);
+            addQuad(triangles, o + x, z, y, split);
+            addQuad(triangles, o + y, x, z, split);
+        }
+}
+
+// How far a point is inside the nearest building, 0 if it's outside all of them
+float penetration(glm::vec3 p, float radius, unsigned int blocks)
+{
+    float deepest = 0;
+    for(unsigned int i = 0; i < blocks; i++)
+        for(unsigned int j = 0; j < blocks; j++){
+            glm::vec3 lo(i * BLOCK, 0, j * BLOCK), hi = lo + glm::vec3(BUILDING, height(i, j), BUILDING);
+            glm::vec3 closest = glm::clamp(p, lo, hi);
+            float depth;
+            if(closest == p)
+                depth = radius + glm::min(glm::min(glm::min(p - lo, hi - p).x, glm::min(p - lo, hi - p).y), glm::min(p - lo, hi - p).z);
+            else
+                depth = radius - glm::length(p - closest);
+            deepest = glm::max(deepest, depth);
+        }
+    return deepest;
+}
+
+// Somewhere in the streets, not touching a building
+glm::vec3 streetPoint(unsigned int blocks, float radius)
+{
+    glm::vec3 p;
+    do
+        p = glm::vec3(randomIn(-2, blocks * BLOCK), randomIn(0.5f, 12), randomIn(-2, blocks * BLOCK));
+    while(penetration(p, radius, blocks) > 0);
+    return p;
+}
+
+// Runs the cameras through the city once and returns ns/camera/frame. With a collider, fails if a camera
+// ends up deeper than tolerance inside a building
+double flyThrough(const std::vector<glm::vec3> &starts, const std::vector<glm::vec3> &targets, const CameraCollider *collider,
+                  unsigned int frames, unsigned int threads, unsigned int blocks, unsigned int &inside)
+{
+    CameraSystem system;
+    system.Collider = collider;
+    for(unsigned int i = 0; i < starts.size(); i++){
+        system.Add(starts[i]);
+        system.Translate(i, targets[i], frames * FRAME_TIME);
+    }
+
+    inside = 0;
+    Timer timer;
+    double checking = 0;
+    for(unsigned int f = 1; f <= frames; f++){
+        system.Update(f * FRAME_TIME, threads);
+
+        // a sample of frames, not timed
+        if(f % 16 == 0 || f == frames){
+            Timer check;
+            for(unsigned int i = 0; i < system.Size(); i++)
+                if(penetration(system.Position.get(i), system.CollisionRadius, blocks) > 1e-3f)
+                    inside++;
+            checking += check.seconds();
+        }
+    }
+    return (timer.seconds() - checking) * 1e9 / ((double)frames * starts.size());
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int blocks = argc > 1 ? atoi(argv[1]) : 16;
+    unsigned int cameraCount = argc > 2 ? atoi(argv[2]) : 512;
+    unsigned int frames = argc > 3 ? atoi(argv[3]) : 300;
+    unsigned int maxThreads = argc > 4 ? atoi(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+    if(blocks < 1)
+        blocks = 1;
+    if(maxThreads < 1)
+        maxThreads = 1;
+
+    std::vector<bvhTriangle> triangles;
+    buildCity(blocks, 8, triangles);
+    printf("buildings: %u, triangles: %u, cameras: %u, frames: %u\n", blocks * blocks, (unsigned int)triangles.size(), cameraCount, frames);
+    bool failed = false;
+
+    // building
+    TriangleBVH reference;
+    Timer timer;
+    reference.Build(triangles, 1);
+    printf("| build, 1 thread   %10.1f ms   %u nodes\n", timer.seconds() * 1e3, (unsigned int)reference.Nodes.size());
+    for(unsigned int threads = 2; threads <= maxThreads; threads *= 2){
+        TriangleBVH tree;
+        timer = Timer();
+        tree.Build(triangles, threads);
+        printf("| build, %u threads %10.1f ms\n", threads, timer.seconds() * 1e3);
+        // the same splits whatever the threads, so the same tree
+        if(tree.Nodes.size() != reference.Nodes.size() || memcmp(&tree.Nodes[0], &reference.Nodes[0], tree.Nodes.size() * sizeof(bvhNode)) != 0){
+            printf("| trees built on 1 and %u threads differ\n", threads);
+            failed = true;
+        }
+    }
+
+    // the cache
+    const char *cache = "bench_collision.bvh";
+    timer = Timer();
+    reference.Save(cache, 1);
+    printf("| save              %10.1f ms\n", timer.seconds() * 1e3);
+    TriangleBVH loaded;
+    timer = Timer();
+    bool ok = loaded.Load(cache, 1);
+    printf("| load              %10.1f ms\n", timer.seconds() * 1e3);
+    if(!ok || loaded.Load(cache, 2) || loaded.Nodes.size() != reference.Nodes.size()){
+        printf("| the cache didn't load back, or loaded with the wrong key\n");
+        failed = true;
+    }
+    remove(cache);
+
+    // sweeps against testing every triangle: a tree with a single leaf
+    TriangleBVH brute;
+    brute.Triangles = triangles;
+    bvhNode all = { glm::vec3(-1e30f), 0, glm::vec3(1e30f), (uint32_t)triangles.size() };
+    brute.Nodes.push_back(all);
+    unsigned int hits = 0, mismatches = 0;
+    for(unsigned int i = 0; i < CHECKED_SWEEPS; i++){
+        glm::vec3 p0 = streetPoint(blocks, 0.25f);
+        glm::vec3 p1 = p0 + glm::vec3(randomIn(-15, 15), randomIn(-3, 3), randomIn(-15, 15));
+        float radius = randomIn(0.05f, 1.0f);
+        sweepHit a, b;
+        bool hitA = reference.SweepSphere(p0, p1, radius, a), hitB = brute.SweepSphere(p0, p1, radius, b);
+        hits += hitB;
+        if(hitA != hitB || (hitA && std::fabs(a.Time - b.Time) > 1e-5f))
+            mismatches++;
+    }
+    printf("| sweeps against every triangle: %u of %u hit, %u differ\n", hits, CHECKED_SWEEPS, mismatches);
+    failed = failed || mismatches;
+
+    unsigned int sweeps = 2000;
+    timer = Timer();
+    for(unsigned int i = 0; i < sweeps; i++){
+        sweepHit hit;
+        glm::vec3 p0 = glm::vec3(i % blocks * BLOCK + 8, 2, i / blocks % blocks * BLOCK + 8);
+        hits += reference.SweepSphere(p0, p0 + glm::vec3(3, 0, 1), 0.25f, hit);
+    }
+    printf("| sweep             %10.2f us\n", timer.seconds() * 1e6 / sweeps);
+
+    // cameras flying across the city
+    std::vector<glm::vec3> starts(cameraCount), targets(cameraCount);
+    for(unsigned int i = 0; i < cameraCount; i++){
+        starts[i] = streetPoint(blocks, 0.25f);
+        targets[i] = streetPoint(blocks, 0.25f);
+    }
+    SceneCollider collider;
+    collider.Tree = reference;
+
+    unsigned int inside;
+    double unblocked = flyThrough(starts, targets, NULL, frames, 1, blocks, inside);
+    printf("| no collision, 1 thread      %8.1f ns/camera/frame   %u cameras inside buildings\n", unblocked, inside);
+    for(unsigned int threads = 1; threads <= maxThreads; threads *= 2){
+        double ns = flyThrough(starts, targets, &collider, frames, threads, blocks, inside);
+        printf("| collision, %u thread%s        %8.1f ns/camera/frame   %u cameras inside buildings\n", threads, threads > 1 ? "s" : " ", ns, inside);
+        failed = failed || inside;
+    }
+
+    printf("(checksum %u)\n", hits);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+#include <glm/glm.hpp>
+#include <glm/gtx/spline.hpp>
+
+#include <learnopengl/bezier_curve.h>
+#include <learnopengl/curve_kernels.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Throughput of the batch curve kernels against per-point evaluation.
+// usage: bench_curve_kernels [points] [repeats]
+
+// The per-point path Camera::Bezier used to take
+glm::vec3 bezierPow(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t)
+{
+    return (float)pow(1-t, 3) * p0 +
+           3 * (float)pow(1-t, 2) * t * p1 +
+           3 * (1-t) * (float)pow(t, 2) * p2 +
+           (float)pow(t, 3) * p3;
+}
+
+struct Timer {
+    std::chrono::high_resolution_clock::time_point begin;
+    Timer() : begin(std::chrono::high_resolution_clock::now()) {}
+    double seconds() const { return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count(); }
+};
+
+float maxError(const std::vector<glm::vec3> &reference, const std::vector<float> &x, const std::vector<float> &y, const std::vector<float> &z)
+{
+    float error = 0;
+    for(unsigned int i = 0; i < reference.size(); i++)
+        error = glm::max(error, glm::length(reference[i] - glm::vec3(x[i], y[i], z[i])));
+    return error;
+}
+
+void report(const char *name, double seconds, double points, float error)
+{
+    printf("| %-34s %10.1f Mpoints/s   max error %g\n", name, points / seconds / 1e6, error);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int count = argc > 1 ? atoi(argv[1]) : 1 << 16;
+    unsigned int repeats = argc > 2 ? atoi(argv[2]) : 200;
+    // the parameters run from 0 to 1, so there are at least two of them
+    if(count < 2)
+        count = 2;
+    if(repeats < 1)
+        repeats = 1;
+    double points = (double)count * repeats;
+
+    glm::vec3 p0(0, 0, 0), p1(0, 10, -10), p2(0, 10, 10), p3(5, 5, 5);
+    std::vector<float> t(count), x(count), y(count), z(count);
+    for(unsigned int i = 0; i < count; i++)
+        t[i] = (float)i / (count - 1);
+
+    std::vector<glm::vec3> bezier(count), catmullRom(count);
+    float sink = 0;
+
+    printf("points: %u, repeats: %u\n", count, repeats);
+#if defined(__AVX__)
+    printf("| kernels: AVX\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+    printf("| kernels: SSE2\n");
+#else
+    printf("| kernels: scalar\n");
+#endif
+
+    // one curve, many parameter values
+    Timer timer;
+    for(unsigned int r = 0; r < repeats; r++){
+        for(unsigned int i = 0; i < count; i++)
+            bezier[i] = bezierPow(p0, p1, p2, p3, t[i]);
+        sink += bezier[r % count].x;
+    }
+    report("Bezier, pow() per point", timer.seconds(), points, 0);
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        for(unsigned int i = 0; i < count; i++){
+            CubicSamplesScalar(CubicCoefficients(BEZIER_BASIS, p0.x, p1.x, p2.x, p3.x), &t[i], &x[i], 1);
+            CubicSamplesScalar(CubicCoefficients(BEZIER_BASIS, p0.y, p1.y, p2.y, p3.y), &t[i], &y[i], 1);
+            CubicSamplesScalar(CubicCoefficients(BEZIER_BASIS, p0.z, p1.z, p2.z, p3.z), &t[i], &z[i], 1);
+        }
+        sink += x[r % count];
+    }
+    report("Bezier, scalar Horner", timer.seconds(), points, maxError(bezier, x, y, z));
+
+    BezierCurve<3> cubic = {{ p0, p1, p2, p3 }};
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        for(unsigned int i = 0; i < count; i++){
+            glm::vec3 v = cubic(t[i]);
+            x[i] = v.x;
+            y[i] = v.y;
+            z[i] = v.z;
+        }
+        sink += x[r % count];
+    }
+    report("Bezier, unrolled de Casteljau", timer.seconds(), points, maxError(bezier, x, y, z));
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        CurveSamples(BEZIER_BASIS, p0, p1, p2, p3, &t[0], &x[0], &y[0], &z[0], count);
+        sink += x[r % count];
+    }
+    report("Bezier, SIMD Horner", timer.seconds(), points, maxError(bezier, x, y, z));
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        CurveUniform(BEZIER_BASIS, p0, p1, p2, p3, &x[0], &y[0], &z[0], count);
+        sink += x[r % count];
+    }
+    report("Bezier, forward differencing", timer.seconds(), points, maxError(bezier, x, y, z));
+
+    // exact quarter circle, as a rational quadratic and as a NURBS
+    RationalBezierCurve<2> arc = CircularArc(glm::vec3(0), glm::vec3(10, 0, 0), glm::vec3(0, 10, 0));
+    timer = Timer();
+    float arcError = 0;
+    for(unsigned int r = 0; r < repeats; r++){
+        for(unsigned int i = 0; i < count; i++){
+            glm::vec3 v = arc(t[i]);
+            x[i] = v.x;
+            y[i] = v.y;
+        }
+        sink += x[r % count];
+    }
+    for(unsigned int i = 0; i < count; i++)
+        arcError = glm::max(arcError, std::fabs(std::sqrt(x[i] * x[i] + y[i] * y[i]) - 10));
+    report("quarter circle, rational Bezier", timer.seconds(), points, arcError);
+
+    NurbsCurve<2> circle = NurbsCircle(glm::vec3(0), 10.0f);
+    timer = Timer();
+    arcError = 0;
+    for(unsigned int r = 0; r < repeats; r++){
+        unsigned int cursor = 2;
+        for(unsigned int i = 0; i < count; i++){
+            glm::vec3 v = circle.Evaluate(t[i], cursor);
+            x[i] = v.x;
+            z[i] = v.z;
+        }
+        sink += x[r % count];
+    }
+    for(unsigned int i = 0; i < count; i++)
+        arcError = glm::max(arcError, std::fabs(std::sqrt(x[i] * x[i] + z[i] * z[i]) - 10));
+    report("full circle, NURBS", timer.seconds(), points, arcError);
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        for(unsigned int i = 0; i < count; i++)
+            catmullRom[i] = glm::catmullRom(p0, p1, p2, p3, t[i]);
+        sink += catmullRom[r % count].x;
+    }
+    report("catmullRom, glm per point", timer.seconds(), points, 0);
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        CurveSamples(CATMULL_ROM_BASIS, p0, p1, p2, p3, &t[0], &x[0], &y[0], &z[0], count);
+        sink += x[r % count];
+    }
+    report("catmullRom, SIMD Horner", timer.seconds(), points, maxError(catmullRom, x, y, z));
+
+    // many curves (one per camera), one parameter value each
+    std::vector<float> c0(count), c1(count), c2(count), c3(count);
+    for(unsigned int i = 0; i < count; i++){
+        c0[i] = p0.x + i % 13;
+        c1[i] = p1.x - i % 7;
+        c2[i] = p2.x + i % 5;
+        c3[i] = p3.x - i % 3;
+    }
+    std::vector<float> reference(count);
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        CubicBatchScalar(BEZIER_BASIS, &c0[0], &c1[0], &c2[0], &c3[0], &t[0], &reference[0], count);
+        sink += reference[r % count];
+    }
+    report("Bezier per camera, scalar", timer.seconds(), points, 0);
+
+    timer = Timer();
+    for(unsigned int r = 0; r < repeats; r++){
+        CubicBatch(BEZIER_BASIS, &c0[0], &c1[0], &c2[0], &c3[0], &t[0], &x[0], count);
+        sink += x[r % count];
+    }
+    float error = 0;
+    for(unsigned int i = 0; i < count; i++)
+        error = glm::max(error, std::fabs(reference[i] - x[i]));
+    report("Bezier per camera, SIMD", timer.seconds(), points, error);
+
+    printf("(checksum %f)\n", sink);
+    return 0;
+}
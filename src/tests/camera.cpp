@@ -0,0 +1,63 @@
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_system.h>
+
+#include <cmath>
+#include <cstdio>
+
+// Transformations that take no time: each one must land on its end on the first evaluation, stay there
+// on the next, and agree with a CameraSystem given the same commands.
+
+static unsigned int failures = 0;
+
+static void check(bool ok, const char *what, unsigned int step)
+{
+    if(!ok && failures++ < 10)
+        printf("| %s, step %u\n", what, step);
+}
+
+static bool finite(glm::vec3 v)
+{
+    return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+}
+
+static bool near(glm::vec3 a, glm::vec3 b)
+{
+    return glm::length(a - b) < 1e-3f;
+}
+
+int main()
+{
+    glm::vec3 start(0, 5, 3), p(1, 2, 3), a(0, 10, -10), b(0, 10, 10), c(5, 5, 5);
+
+    for(unsigned int step = 0; step < 6; step++){
+        Camera camera(start);
+        CameraSystem system;
+        unsigned int id = system.Add(start);
+        switch(step){
+            case 0: camera.Translate(p, 0); system.Translate(id, p, 0); break;
+            case 1: camera.bezierPath(start, a, b, c, 0); system.bezierPath(id, start, a, b, c, 0); break;
+            case 2: camera.bSplinePath(start, a, b, c, 0); system.bSplinePath(id, start, a, b, c, 0); break;
+            case 3: camera.rotateRP(b, glm::radians(45.0f), 0); system.rotateRP(id, b, glm::radians(45.0f), 0); break;
+            case 4: camera.rotateRA(glm::vec3(0, 1, 0), glm::radians(90.0f), 0); system.rotateRA(id, glm::vec3(0, 1, 0), glm::radians(90.0f), 0); break;
+            case 5: camera.LookAt(c, 0); system.LookAt(id, c, 0); break;
+        }
+
+        camera.evaluateAt(1);
+        check(finite(camera.Position) && finite(camera.Front), "a zero-duration transformation gave NaN", step);
+        glm::vec3 position = camera.Position, front = camera.Front;
+        camera.evaluateAt(1);
+        check(camera.Position == position && camera.Front == front, "a second evaluation at the same time moved the camera", step);
+
+        system.Update(1);
+        check(near(camera.Position, system.Position.get(id)) && near(camera.Front, system.Front.get(id)), "Camera and CameraSystem disagree", step);
+        if(step == 0)
+            check(near(camera.Position, p), "a zero-duration translation didn't end on its point", step);
+        if(step == 1)
+            check(near(camera.Position, c), "a zero-duration Bezier path didn't end on its last point", step);
+    }
+
+    printf("%u failures\n", failures);
+    return failures ? 1 : 0;
+}
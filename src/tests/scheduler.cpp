@@ -0,0 +1,177 @@
+#include <glm/glm.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_scheduler.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Fires timers spread over far more ticks than the wheel holds, advancing by small steps and by huge
+// jumps, and checks that every one fires once, on its tick, in order, and that a jump over empty ticks
+// doesn't step through them. Then checks that a command scheduled at t runs on Update(t), repeats included.
+
+static unsigned int failures = 0;
+
+static void check(bool ok, const char *what, unsigned int index)
+{
+    if(!ok && failures++ < 10)
+        printf("| %s, %u\n", what, index);
+}
+
+struct expected {
+    uint64_t Due;
+    uint64_t Fired;
+    unsigned int Times;
+};
+
+// Records the tick each timer fired on, and checks they come in order
+struct recorder {
+    TimerWheel<unsigned int> &Wheel;
+    std::vector<expected> &Timers;
+    uint64_t Last;
+    unsigned int LastIndex;
+
+    recorder(TimerWheel<unsigned int> &wheel, std::vector<expected> &timers) : Wheel(wheel), Timers(timers), Last(0), LastIndex(0) {}
+
+    bool operator()(unsigned int &index, uint64_t &){
+        uint64_t tick = Wheel.Now();
+        check(tick >= Last, "a timer fired before an earlier one", index);
+        // on the same tick, in the order they were added
+        check(tick > Last || index > LastIndex || Last == 0, "timers on the same tick fired out of order", index);
+        Last = tick;
+        LastIndex = index;
+        Timers[index].Fired = tick;
+        Timers[index].Times++;
+        return false;
+    }
+};
+
+static uint64_t randomTicks(uint64_t range)
+{
+    return ((uint64_t)rand() << 31 ^ (uint64_t)rand() << 16 ^ (uint64_t)rand()) % range;
+}
+
+static void wheel()
+{
+    // the wheel holds 2^24 ticks, these go well past it
+    TimerWheel<unsigned int> wheel;
+    std::vector<expected> timers;
+    for(unsigned int i = 0; i < 20000; i++){
+        uint64_t range = i % 4 == 0 ? (uint64_t(1) << 30) : i % 4 == 1 ? (uint64_t(1) << 20) : 5000;
+        expected e = { randomTicks(range), 0, 0 };
+        timers.push_back(e);
+        wheel.Add(e.Due, i);
+    }
+    // a few on the same tick
+    for(unsigned int i = 0; i < 100; i++){
+        expected e = { 4097, 0, 0 };
+        timers.push_back(e);
+        wheel.Add(e.Due, (unsigned int)timers.size() - 1);
+    }
+
+    recorder record(wheel, timers);
+    uint64_t tick = 0;
+    unsigned int steps = 0;
+    while(wheel.Size()){
+        // frame-sized steps at first, then longer and longer stalls
+        tick += steps < 2000 ? 16 : randomTicks(uint64_t(1) << (steps % 28));
+        wheel.Advance(tick, record);
+        steps++;
+    }
+    for(unsigned int i = 0; i < timers.size(); i++){
+        check(timers[i].Times == 1, "a timer didn't fire exactly once", i);
+        check(timers[i].Fired == timers[i].Due, "a timer fired on the wrong tick", i);
+    }
+
+    // a timer added late, due in the past, fires on the next Advance
+    expected late = { 0, 0, 0 };
+    timers.assign(1, late);
+    uint64_t next = wheel.Now();
+    wheel.Add(0, 0);
+    record.Last = 0;
+    wheel.Advance(next, record);
+    check(timers[0].Times == 1 && timers[0].Fired == next, "a timer due in the past didn't fire on the next Advance", 0);
+
+    // a first Advance years of milliseconds ahead, with a timer near the end
+    TimerWheel<unsigned int> far;
+    expected distant = { (uint64_t(1) << 40) - 5, 0, 0 };
+    timers.assign(1, distant);
+    far.Add(distant.Due, 0);
+    recorder recordFar(far, timers);
+    std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+    far.Advance(uint64_t(1) << 40, recordFar);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+    check(timers[0].Times == 1 && timers[0].Fired == distant.Due, "the distant timer didn't fire on its tick", 0);
+    check(seconds < 1.0, "advancing over empty ticks stepped through them", (unsigned int)(seconds * 1e3));
+    printf("| %u timers, %u advances, 2^40 ticks in %.3f ms\n", (unsigned int)timers.size(), steps, seconds * 1e3);
+}
+
+static void scheduler()
+{
+    std::vector<Camera> cameras(1);
+    cameraCommand command = StopNoiseCommand(0);
+
+    // Schedule(t) then Update(t) runs it, and an update a couple of ticks before doesn't
+    std::vector<float> times;
+    float fixed[] = { 0.0f, 0.001f, 0.0015f, 0.0025f, 0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 3.3f, 10.0f, 16.7f, 100.0f, 1000.0f, 12345.678f };
+    times.assign(fixed, fixed + sizeof(fixed) / sizeof(fixed[0]));
+    for(unsigned int i = 0; i < 5000; i++)
+        times.push_back(rand() / (float)RAND_MAX * (i % 2 ? 10.0f : 5000.0f));
+    for(unsigned int i = 0; i < times.size(); i++){
+        CameraScheduler s;
+        s.Schedule(times[i], command);
+        if(times[i] > 0.01f)
+            check(s.Update(times[i] - 2 * s.Resolution, cameras) == 0, "a command ran early", i);
+        check(s.Update(times[i], cameras) == 1, "Update(t) didn't run a command scheduled at t", i);
+        check(s.Pending() == 0, "a command that ran is still pending", i);
+    }
+
+    // the same on one scheduler, with the clock going forward
+    CameraScheduler running;
+    float now = 0;
+    for(unsigned int i = 0; i < 5000; i++){
+        now += rand() / (float)RAND_MAX * 0.05f;
+        running.Schedule(now, command);
+        check(running.Update(now, cameras) == 1, "Update(t) didn't run a command scheduled at t, running clock", i);
+    }
+
+    // repeats run on Update(at + k * interval), and stop after the last one
+    float starts[] = { 0.0f, 0.25f, 1.0f, 3.3f, 0.0015f, 42.5f };
+    float intervals[] = { 0.5f, 0.125f, 0.1f, 1.0f / 60.0f, 0.0016f, 2.0f, 0.0004f };
+    for(unsigned int a = 0; a < sizeof(starts) / sizeof(starts[0]); a++)
+        for(unsigned int b = 0; b < sizeof(intervals) / sizeof(intervals[0]); b++){
+            CameraScheduler s;
+            float at = starts[a], interval = intervals[b];
+            // shorter than a tick: one run per tick at most
+            bool shortInterval = interval < s.Resolution;
+            unsigned int repeats = 20, ran = 0;
+            s.Schedule(at, command, interval, repeats);
+            for(unsigned int k = 0; k <= repeats; k++){
+                unsigned int n = s.Update((float)(at + (double)k * interval), cameras);
+                ran += n;
+                if(!shortInterval)
+                    check(n == 1, "a repeat didn't run on its update", a * 100 + b * 10 + k % 10);
+            }
+            ran += s.Update(at + (repeats + 1) * interval + 1.0f, cameras);
+            check(ran == repeats + 1 && s.Pending() == 0, "wrong number of repeats", a * 100 + b);
+        }
+
+    // a first Update long after everything was due runs it all at once
+    CameraScheduler late;
+    late.Schedule(10, command);
+    late.Schedule(1000, command);
+    late.Schedule(100000, command);
+    late.Schedule(0.5f, command, 0.5f, 9);
+    check(late.Update(200000, cameras) == 13, "a late first update didn't run everything due", 0);
+}
+
+int main()
+{
+    srand(1);
+    wheel();
+    scheduler();
+    printf("%u failures\n", failures);
+    return failures ? 1 : 0;
+}
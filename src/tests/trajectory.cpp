@@ -0,0 +1,162 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/camera.h>
+#include <learnopengl/camera_trajectory.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Writes a trajectory, reads it back and checks every frame and blended sample against what was written,
+// within the quantization steps of the format. Then damages a block in the middle and checks that the file
+// still opens, that the frames before the block still decode, and that reaching it is reported.
+
+const float SAMPLE_RATE = 60.0f;
+const float POSITION_STEP = 1.0f / 1024.0f;
+const unsigned int FRAMES = 5000;
+
+static unsigned int failures = 0;
+
+static void check(bool ok, const char *what, unsigned int frame)
+{
+    if(!ok && failures++ < 10)
+        printf("| %s, frame %u\n", what, frame);
+}
+
+static trajectoryPose pose(unsigned int i)
+{
+    float t = i / SAMPLE_RATE;
+    trajectoryPose p;
+    p.Position = glm::vec3(40 * std::sin(t * 0.3f), 5 + std::sin(t * 2.1f), 30 * std::cos(t * 0.2f));
+    // a jump every 1500 frames, too far for a delta, starts a new block
+    p.Position.x += (float)(i / 1500) * 100.0f;
+    p.Orientation = glm::angleAxis(t * 0.7f, glm::normalize(glm::vec3(0.2f, 1.0f, 0.1f))) * glm::angleAxis(std::sin(t) * 0.3f, glm::vec3(1, 0, 0));
+    p.Zoom = 45 + 10 * std::sin(t * 0.5f);
+    p.Near = 0.1f;
+    p.Far = i < 3000 ? 100.0f : 200.0f;
+    return p;
+}
+
+// Angle between two orientations, in radians. From the rotation between them, since acos of a dot
+// product near 1 has no precision left at these angles
+static float angle(glm::quat a, glm::quat b)
+{
+    glm::quat r = glm::conjugate(a) * b;
+    return 2 * std::atan2(glm::length(glm::vec3(r.x, r.y, r.z)), std::fabs(r.w));
+}
+
+static void compare(const trajectoryPose &read, const trajectoryPose &written, unsigned int frame)
+{
+    // rounding to the step, plus the float error of positions of up to a few hundred units
+    check(glm::length(read.Position - written.Position) <= POSITION_STEP + 1e-4f, "position outside the quantization step", frame);
+    check(angle(read.Orientation, written.Orientation) < 2e-4f, "orientation outside the quantization step", frame);
+    check(std::fabs(read.Zoom - written.Zoom) <= TRAJECTORY_ZOOM_STEP / 2 + 1e-4f, "zoom outside the quantization step", frame);
+    check(read.Near == written.Near && read.Far == written.Far, "near or far changed", frame);
+}
+
+int main()
+{
+    const char *path = "test_trajectory.ctrj";
+    const char *damagedPath = "test_trajectory_damaged.ctrj";
+
+    TrajectoryWriter writer;
+    if(!writer.Open(path, SAMPLE_RATE, POSITION_STEP)){
+        printf("can't write %s\n", path);
+        return 1;
+    }
+    for(unsigned int i = 0; i < FRAMES; i++){
+        trajectoryPose p = pose(i);
+        writer.Add(p.Position, p.Orientation, p.Zoom, p.Near, p.Far);
+    }
+    check(writer.Close(), "writing failed", 0);
+
+    CameraTrajectory trajectory;
+    if(!trajectory.Open(path)){
+        printf("can't open %s\n", path);
+        return 1;
+    }
+    check(trajectory.Frames() == FRAMES, "wrong frame count", trajectory.Frames());
+
+    // every frame, in order and at random
+    trajectoryCursor cursor;
+    for(unsigned int i = 0; i < FRAMES; i++)
+        compare(trajectory.Frame(i, cursor), pose(i), i);
+    for(unsigned int k = 0; k < 2000; k++){
+        unsigned int i = (k * 2654435761u) % FRAMES;
+        compare(trajectory.Frame(i), pose(i), i);
+    }
+
+    // halfway between frames: the blend of the two, so the error bounds still hold against the blend of the originals
+    cursor = trajectoryCursor();
+    for(unsigned int i = 0; i + 1 < FRAMES; i++){
+        trajectoryPose a = pose(i), b = pose(i + 1), mid = a;
+        mid.Position = (a.Position + b.Position) * 0.5f;
+        glm::quat q = glm::dot(a.Orientation, b.Orientation) < 0 ? -b.Orientation : b.Orientation;
+        mid.Orientation = glm::normalize(a.Orientation + q);
+        mid.Zoom = (a.Zoom + b.Zoom) * 0.5f;
+        // the frame a jump lands on is a new block, and blending towards it isn't meaningful
+        if(glm::length(a.Position - b.Position) < 10)
+            compare(trajectory.Sample((i + 0.5f) / SAMPLE_RATE, cursor), mid, i);
+    }
+    check(!cursor.Damaged, "an intact file reported damage", 0);
+    trajectory.Close();
+
+    // a copy with the frame count of the block holding frame 2000 broken
+    FILE *in = fopen(path, "rb");
+    std::vector<unsigned char> bytes;
+    unsigned char chunk[4096];
+    size_t read;
+    while(in && (read = fread(chunk, 1, sizeof(chunk), in)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + read);
+    if(in)
+        fclose(in);
+    trajectoryHeader header;
+    memcpy(&header, &bytes[0], sizeof(header));
+    unsigned int damagedBlock = header.Blocks / 2;
+    uint64_t offset;
+    memcpy(&offset, &bytes[header.BlockTable + damagedBlock * sizeof(uint64_t)], sizeof(offset));
+    trajectoryBlock block;
+    memcpy(&block, &bytes[offset], sizeof(block));
+    unsigned int firstDamaged = block.FirstFrame;
+    block.Frames = 0xffffff;
+    memcpy(&bytes[offset], &block, sizeof(block));
+    FILE *out = fopen(damagedPath, "wb");
+    check(out && fwrite(&bytes[0], 1, bytes.size(), out) == bytes.size(), "can't write the damaged copy", 0);
+    if(out)
+        fclose(out);
+
+    // blocks are only checked when they're reached, so the file opens and its start plays
+    check(trajectory.Open(damagedPath), "a file with a damaged block didn't open", 0);
+    cursor = trajectoryCursor();
+    for(unsigned int i = 0; i < firstDamaged; i++)
+        compare(trajectory.Frame(i, cursor), pose(i), i);
+    check(!cursor.Damaged, "damage reported before the damaged block", firstDamaged);
+    trajectoryPose last = trajectory.Frame(firstDamaged, cursor);
+    check(cursor.Damaged, "the damaged block wasn't reported", firstDamaged);
+    check(cursor.Frame == firstDamaged - 1 && last.Position == trajectory.Frame(firstDamaged - 1).Position, "the cursor moved into the damaged block", firstDamaged);
+
+    // and a camera playing it stops there
+    Camera camera;
+    camera.evaluateAt(0);
+    camera.playTrajectory(&trajectory);
+    for(unsigned int i = 0; i < FRAMES; i++)
+        camera.evaluateAt(i / SAMPLE_RATE);
+    check(glm::length(camera.Position - pose(firstDamaged - 1).Position) < 0.01f, "the camera didn't stop at the damaged block", firstDamaged);
+    trajectory.Close();
+
+    // a table that doesn't fit in the file is caught on Open
+    bytes.resize(header.BlockTable + 4);
+    out = fopen(damagedPath, "wb");
+    if(out){
+        fwrite(&bytes[0], 1, bytes.size(), out);
+        fclose(out);
+    }
+    check(!trajectory.Open(damagedPath), "a truncated file opened", 0);
+
+    remove(path);
+    remove(damagedPath);
+    printf("%u frames, %u blocks, %u failures\n", FRAMES, header.Blocks, failures);
+    return failures ? 1 : 0;
+}
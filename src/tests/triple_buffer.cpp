@@ -0,0 +1,80 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/camera_snapshot.h>
+
+#include <cstdio>
+#include <thread>
+
+// A writer thread publishes snapshots with every field set to the same sequence number while a reader
+// thread takes them as fast as it can. Every snapshot the reader sees must be whole (one number in every
+// field), newer than the one before, and the last one published must get through.
+
+const unsigned int SNAPSHOTS = 200000;
+
+static unsigned int failures = 0;
+
+static void check(bool ok, const char *what, unsigned int snapshot)
+{
+    if(!ok && failures++ < 10)
+        printf("| %s, snapshot %u\n", what, snapshot);
+}
+
+static void fill(cameraSnapshot &s, float n)
+{
+    s.View = s.Projection = s.ViewProjection = glm::mat4(n);
+    s.Position = s.Front = s.Up = s.Right = glm::vec3(n);
+    s.Orientation = glm::quat(n, n, n, n);
+    s.Zoom = s.Near = s.Far = s.Time = n;
+}
+
+// The number in every field, or -1 if they differ
+static float sequence(const cameraSnapshot &s)
+{
+    float n = s.Time;
+    bool whole = s.View == glm::mat4(n) && s.Projection == glm::mat4(n) && s.ViewProjection == glm::mat4(n) &&
+        s.Position == glm::vec3(n) && s.Front == glm::vec3(n) && s.Up == glm::vec3(n) && s.Right == glm::vec3(n) &&
+        s.Orientation == glm::quat(n, n, n, n) && s.Zoom == n && s.Near == n && s.Far == n;
+    return whole ? n : -1;
+}
+
+static void publish(TripleBuffer<cameraSnapshot> *buffer)
+{
+    for(unsigned int i = 1; i <= SNAPSHOTS; i++){
+        fill(buffer->Back(), (float)i);
+        buffer->Publish();
+        if(i % 1000 == 0)
+            std::this_thread::yield();
+    }
+}
+
+int main()
+{
+    TripleBuffer<cameraSnapshot> buffer;
+    fill(buffer.Back(), 0);
+    buffer.Publish();
+    check(buffer.Update() && sequence(buffer.Front()) == 0, "the first snapshot didn't get through", 0);
+    check(!buffer.Update(), "Update found a snapshot when none was published", 0);
+
+    std::thread writer(publish, &buffer);
+    float last = 0;
+    unsigned int taken = 0;
+    while(last < SNAPSHOTS){
+        if(!buffer.Update()){
+            std::this_thread::yield();
+            continue;
+        }
+        float n = sequence(buffer.Front());
+        check(n >= 0, "a torn snapshot", taken);
+        check(n > last, "an older snapshot after a newer one", (unsigned int)n);
+        if(n > last)
+            last = n;
+        taken++;
+    }
+    writer.join();
+    check(!buffer.Update(), "Update found a snapshot after the last one was taken", taken);
+    check(sequence(buffer.Front()) == SNAPSHOTS, "the last snapshot changed", taken);
+
+    printf("%u snapshots published, %u taken, %u failures\n", SNAPSHOTS, taken, failures);
+    return failures ? 1 : 0;
+}